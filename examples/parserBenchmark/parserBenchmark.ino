@@ -0,0 +1,269 @@
+/*
+ * Benchmark sketch for the frame parser in the LD2410 library.
+ *
+ * It does not need a sensor connected. Captured and synthetic LD2410 byte streams are played into the library from memory using
+ * a Stream stand-in and the time taken to parse them is reported on the Serial Monitor as frames/s and ns/byte, along with the
+ * worst single pass seen.
+ *
+ * The streams covered are...
+ *
+ * Normal data frames (0x02 0xAA)
+ * Engineering mode data frames (0x01 0xAA)
+ * ACK frames for every command opcode the library understands
+ * A corrupted stream full of false headers and truncated frames, which is the most branch-heavy case for the parser
+ *
+ * Each stream is measured both with read(), one byte at a time, and with readAvailable(), which drains the buffer in bulk.
+ *
+ * Use this to compare parser changes on the same board before rolling them out.
+ *
+ * It also builds natively on Linux, using the library's Linux port, with the results going to standard output. From the root of
+ * the library...
+ *
+ * g++ -std=gnu++11 -O2 -Isrc -x c++ examples/parserBenchmark/parserBenchmark.ino -x none src/ld2410*.cpp -o parserBenchmark -lpthread
+ *
+ */
+
+#include <ld2410.h>
+
+#define BENCHMARK_PASSES 200
+#define BENCHMARK_BUFFER_LENGTH 400
+
+/*
+ * A Stream that plays back a buffer in memory, anything written to it is discarded
+ */
+class MemoryStream : public Stream
+{
+  public:
+    void load(const uint8_t *data, size_t length)
+    {
+      data_ = data;
+      length_ = length;
+      position_ = 0;
+    }
+    void rewind()
+    {
+      position_ = 0;
+    }
+    int available()
+    {
+      return length_ - position_;
+    }
+    int read()
+    {
+      if(position_ < length_)
+      {
+        return data_[position_++];
+      }
+      return -1;
+    }
+    int peek()
+    {
+      if(position_ < length_)
+      {
+        return data_[position_];
+      }
+      return -1;
+    }
+    size_t write(uint8_t)
+    {
+      return 1;
+    }
+    using Print::write;
+  private:
+    const uint8_t *data_ = nullptr;
+    size_t length_ = 0;
+    size_t position_ = 0;
+};
+
+#if defined(LD2410_LINUX_PORT)
+#include <stdio.h>
+/*
+ * Standard output in place of the Serial Monitor
+ */
+class StandardOutput : public Print
+{
+  public:
+    void begin(unsigned long)
+    {
+    }
+    size_t write(uint8_t byte)
+    {
+      return fwrite(&byte, 1, 1, stdout);
+    }
+    using Print::write;
+};
+StandardOutput Serial;
+#endif
+
+ld2410 radar;
+MemoryStream radarStream;
+uint8_t streamBuffer[BENCHMARK_BUFFER_LENGTH];
+
+//Captured normal data frame, moving and stationary target
+const uint8_t normalFrame[] = {0xF4, 0xF3, 0xF2, 0xF1, 0x0D, 0x00, 0x02, 0xAA, 0x03, 0x4E, 0x00, 0x3C, 0x52, 0x00, 0x64, 0x50, 0x00, 0x55, 0x00, 0xF8, 0xF7, 0xF6, 0xF5};
+
+//Captured engineering mode data frame with per gate energy
+const uint8_t engineeringFrame[] = {0xF4, 0xF3, 0xF2, 0xF1, 0x23, 0x00, 0x01, 0xAA, 0x03, 0x1E, 0x00, 0x3C, 0x00, 0x00, 0x39, 0x00, 0x00, 0x08, 0x08,
+                                    0x3C, 0x22, 0x05, 0x03, 0x03, 0x04, 0x03, 0x06, 0x05, 0x00, 0x00, 0x39, 0x10, 0x13, 0x06, 0x06, 0x08, 0x04,
+                                    0x03, 0x05, 0x55, 0x00, 0xF8, 0xF7, 0xF6, 0xF5};
+
+//ACK frames for every command, back to back
+const uint8_t ackFrames[] = {
+  0xFD, 0xFC, 0xFB, 0xFA, 0x08, 0x00, 0xFF, 0x01, 0x00, 0x00, 0x01, 0x00, 0x40, 0x00, 0x04, 0x03, 0x02, 0x01,  //Enter configuration mode
+  0xFD, 0xFC, 0xFB, 0xFA, 0x04, 0x00, 0x60, 0x01, 0x00, 0x00, 0x04, 0x03, 0x02, 0x01,  //Set max values
+  0xFD, 0xFC, 0xFB, 0xFA, 0x1C, 0x00, 0x61, 0x01, 0x00, 0x00, 0xAA, 0x08, 0x08, 0x08, 0x32, 0x32, 0x28, 0x1E,
+  0x14, 0x0F, 0x0F, 0x0F, 0x0F, 0x00, 0x00, 0x28, 0x28, 0x1E, 0x1E, 0x14, 0x14, 0x14, 0x05, 0x00, 0x04, 0x03, 0x02, 0x01,  //Read configuration
+  0xFD, 0xFC, 0xFB, 0xFA, 0x04, 0x00, 0x62, 0x01, 0x00, 0x00, 0x04, 0x03, 0x02, 0x01,  //Start engineering mode
+  0xFD, 0xFC, 0xFB, 0xFA, 0x04, 0x00, 0x63, 0x01, 0x00, 0x00, 0x04, 0x03, 0x02, 0x01,  //End engineering mode
+  0xFD, 0xFC, 0xFB, 0xFA, 0x04, 0x00, 0x64, 0x01, 0x00, 0x00, 0x04, 0x03, 0x02, 0x01,  //Set gate sensitivity
+  0xFD, 0xFC, 0xFB, 0xFA, 0x0C, 0x00, 0xA0, 0x01, 0x00, 0x00, 0x00, 0x01, 0x02, 0x01, 0x16, 0x24, 0x06, 0x22, 0x04, 0x03, 0x02, 0x01,  //Firmware version
+  0xFD, 0xFC, 0xFB, 0xFA, 0x04, 0x00, 0xA1, 0x01, 0x00, 0x00, 0x04, 0x03, 0x02, 0x01,  //Set baud rate
+  0xFD, 0xFC, 0xFB, 0xFA, 0x04, 0x00, 0xA2, 0x01, 0x00, 0x00, 0x04, 0x03, 0x02, 0x01,  //Factory reset
+  0xFD, 0xFC, 0xFB, 0xFA, 0x04, 0x00, 0xA3, 0x01, 0x00, 0x00, 0x04, 0x03, 0x02, 0x01,  //Restart
+  0xFD, 0xFC, 0xFB, 0xFA, 0x04, 0x00, 0xA4, 0x01, 0x00, 0x00, 0x04, 0x03, 0x02, 0x01,  //Set Bluetooth
+  0xFD, 0xFC, 0xFB, 0xFA, 0x0A, 0x00, 0xA5, 0x01, 0x00, 0x00, 0x8F, 0x27, 0x2E, 0xB8, 0x0F, 0x65, 0x04, 0x03, 0x02, 0x01,  //Get MAC
+  0xFD, 0xFC, 0xFB, 0xFA, 0x04, 0x00, 0xAA, 0x01, 0x00, 0x00, 0x04, 0x03, 0x02, 0x01,  //Set distance resolution
+  0xFD, 0xFC, 0xFB, 0xFA, 0x06, 0x00, 0xAB, 0x01, 0x00, 0x00, 0x00, 0x00, 0x04, 0x03, 0x02, 0x01,  //Read distance resolution
+  0xFD, 0xFC, 0xFB, 0xFA, 0x04, 0x00, 0xFE, 0x01, 0x00, 0x00, 0x04, 0x03, 0x02, 0x01,  //Leave configuration mode
+};
+const uint8_t ackFrameCount = 15;
+
+//Repeat a frame to fill the stream buffer, returns the number of bytes used
+size_t fillBuffer(const uint8_t *frame, size_t frameLength, uint16_t &frames)
+{
+  size_t length = 0;
+  frames = 0;
+  while(length + frameLength <= BENCHMARK_BUFFER_LENGTH)
+  {
+    memcpy(&streamBuffer[length], frame, frameLength);
+    length += frameLength;
+    frames++;
+  }
+  return length;
+}
+
+//Noise with false headers and truncated frames, followed by a valid frame every so often so there is something to find
+size_t fillCorruptedBuffer(uint16_t &frames)
+{
+  size_t length = 0;
+  uint32_t seed = 0x2410;
+  frames = 0;
+  while(length + 2 * sizeof(normalFrame) <= BENCHMARK_BUFFER_LENGTH)
+  {
+    for(uint8_t i = 0; i < sizeof(normalFrame); i++)
+    {
+      seed = seed * 1103515245 + 12345;
+      uint8_t noise = seed >> 16;
+      if((noise & 0x07) == 0)
+      {
+        streamBuffer[length++] = 0xF4; //False data header
+      }
+      else if((noise & 0x07) == 1)
+      {
+        streamBuffer[length++] = 0xFD; //False ACK header
+      }
+      else
+      {
+        streamBuffer[length++] = noise;
+      }
+    }
+    memcpy(&streamBuffer[length], normalFrame, 12); //Truncated frame
+    length += 12;
+    if(length + sizeof(normalFrame) <= BENCHMARK_BUFFER_LENGTH)
+    {
+      memcpy(&streamBuffer[length], normalFrame, sizeof(normalFrame));
+      length += sizeof(normalFrame);
+      frames++;
+    }
+  }
+  return length;
+}
+
+void runBenchmark(const __FlashStringHelper *name, size_t length, uint16_t expectedFrames, bool drain)
+{
+  uint32_t totalMicros = 0;
+  uint32_t worstMicros = 0;
+  uint32_t framesDecoded = 0;
+  radarStream.load(streamBuffer, length);
+  for(uint16_t pass = 0; pass < BENCHMARK_PASSES; pass++)
+  {
+    radarStream.rewind();
+    uint32_t start = micros();
+    if(drain)
+    {
+      framesDecoded += radar.readAvailable();
+    }
+    else
+    {
+      while(radarStream.available())
+      {
+        if(radar.read())
+        {
+          framesDecoded++;
+        }
+      }
+    }
+    uint32_t elapsed = micros() - start;
+    totalMicros += elapsed;
+    if(elapsed > worstMicros)
+    {
+      worstMicros = elapsed;
+    }
+  }
+  uint32_t totalBytes = (uint32_t)length * BENCHMARK_PASSES;
+  Serial.print(name);
+  Serial.print(drain ? F(" readAvailable(): ") : F(" read(): "));
+  Serial.print(framesDecoded);
+  Serial.print('/');
+  Serial.print((uint32_t)expectedFrames * BENCHMARK_PASSES);
+  Serial.print(F(" frames "));
+  if(totalMicros > 0)
+  {
+    Serial.print((uint32_t)((uint64_t)framesDecoded * 1000000 / totalMicros));
+    Serial.print(F(" frames/s "));
+    Serial.print((uint32_t)((uint64_t)totalMicros * 1000 / totalBytes));
+    Serial.print(F(" ns/byte "));
+  }
+  Serial.print(F("worst pass "));
+  Serial.print(worstMicros);
+  Serial.print(F("us for "));
+  Serial.print(length);
+  Serial.println(F(" bytes"));
+}
+
+void setup(void)
+{
+  Serial.begin(115200); //Feedback over Serial Monitor
+  delay(500); //Give a while for Serial Monitor to wake up
+  radar.begin(radarStream, false);
+  Serial.println(F("\nLD2410 parser benchmark"));
+}
+
+void loop()
+{
+  uint16_t frames;
+  size_t length;
+  length = fillBuffer(normalFrame, sizeof(normalFrame), frames);
+  runBenchmark(F("Normal frames"), length, frames, false);
+  runBenchmark(F("Normal frames"), length, frames, true);
+  length = fillBuffer(engineeringFrame, sizeof(engineeringFrame), frames);
+  runBenchmark(F("Engineering frames"), length, frames, false);
+  runBenchmark(F("Engineering frames"), length, frames, true);
+  memcpy(streamBuffer, ackFrames, sizeof(ackFrames));
+  runBenchmark(F("ACK frames"), sizeof(ackFrames), ackFrameCount, false);
+  runBenchmark(F("ACK frames"), sizeof(ackFrames), ackFrameCount, true);
+  length = fillCorruptedBuffer(frames);
+  runBenchmark(F("Corrupted stream"), length, frames, false);
+  runBenchmark(F("Corrupted stream"), length, frames, true);
+  Serial.println();
+  delay(5000);
+}
+
+#if defined(LD2410_LINUX_PORT)
+int main()
+{
+  setup();
+  loop(); //Once is enough, run it again to compare
+  return 0;
+}
+#endif
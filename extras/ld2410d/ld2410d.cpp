@@ -0,0 +1,597 @@
+/*
+ *	ld2410d, serves many LD2410s attached to a Linux gateway from one process and one epoll loop.
+ *
+ *	Each serial device is parsed with the library and the latest state of each sensor is kept. Whenever a sensor's state changes
+ *	it is sent to every client connected to a Unix socket, in the binary messages below, and counters for every sensor are
+ *	served over HTTP in the Prometheus text exposition format.
+ *
+ *	Build from the root of the library with
+ *
+ *		g++ -std=gnu++11 -O2 -Isrc extras/ld2410d/ld2410d.cpp src/ld2410*.cpp -o ld2410d -lpthread
+ *
+ *	and run with eg.
+ *
+ *		ld2410d -s /run/ld2410d.sock -m 9410 /dev/ttyUSB0 /dev/ttyUSB1
+ *
+ *	Options are -s the Unix socket path (default /tmp/ld2410d.sock), -m the metrics TCP port (default 9410, 0 to disable),
+ *	-a the metrics address (default 127.0.0.1) and -b the baud rate (default 256000).
+ *
+ *	Messages on the Unix socket are little-endian. On connecting a client is sent a DEVICE message for each sensor, then a STATE
+ *	message for each sensor that has reported, then a STATE message each time a sensor's state changes.
+ *
+ *	DEVICE (3 + n bytes)	uint8_t type = 0x01, uint8_t sensor, uint8_t n, n bytes of device path
+ *	STATE (16 bytes)		uint8_t type = 0x02, uint8_t sensor, uint8_t target type, uint8_t moving energy, uint8_t stationary energy,
+ *							uint8_t flags (bit 0 connected), uint16_t moving distance, uint16_t stationary distance,
+ *							uint16_t detection distance, uint32_t timestamp (ms, monotonic)
+ *
+ *	A client that can't keep up, ie. its socket buffer is full, is disconnected rather than buffered for. A metrics client has
+ *	LD2410D_METRICS_TIMEOUT ms from connecting to send its request and read the reply, then it is closed.
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#include <ld2410.h>
+#include <ld2410Serial.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#define LD2410D_MESSAGE_DEVICE 0x01
+#define LD2410D_MESSAGE_STATE 0x02
+#define LD2410D_STATE_LENGTH 16
+#define LD2410D_FLAG_CONNECTED 0x01
+#define LD2410D_MAX_SENSORS 255											//Sensor numbers are one byte
+#define LD2410D_MAX_EVENTS 64
+#define LD2410D_RETRY 2000												//How often to try reopening a missing device (ms)
+#define LD2410D_METRICS_TIMEOUT 5000										//How long a metrics client has to send its request and read the reply (ms)
+#define LD2410D_METRICS_REQUEST 4096										//Longest request headers accepted
+#define LD2410D_CONNECTED_TIMEOUT 1000									//A sensor without a good frame for this long is reported disconnected (ms)
+
+#define LD2410D_SENSOR 0												//What each epoll registration is, kept in the top half of its data
+#define LD2410D_STATE_LISTENER 1
+#define LD2410D_STATE_CLIENT 2
+#define LD2410D_METRICS_LISTENER 3
+#define LD2410D_METRICS_CLIENT 4
+
+struct ld2410dSensor {
+	const char *device = nullptr;
+	uint8_t index = 0;
+	ld2410Serial serial;
+	ld2410 radar;
+	bool open = false;
+	uint32_t last_attempt = 0;
+	bool reported = false;												//Whether state holds a reading yet
+	bool connected = false;												//As last published
+	ld2410Reading state = {};
+	uint32_t published = 0;												//STATE messages sent for this sensor
+	uint32_t reconnects = 0;
+};
+
+static int epoll_fd_ = -1;
+static std::vector<ld2410dSensor *> sensors_;
+static std::vector<int> state_clients_;
+static uint32_t clients_dropped_ = 0;
+struct ld2410dMetricsClient {
+	uint32_t accepted = 0;												//millis() when it connected
+	std::string request;												//Received so far, until the blank line ending the headers
+	std::string response;												//Still to be sent, less what has gone
+};
+
+static std::map<int, ld2410dMetricsClient> metrics_clients_;				//By socket
+static volatile sig_atomic_t running_ = 1;
+
+static uint64_t epoll_key_(uint32_t kind, uint32_t value)
+{
+	return ((uint64_t)kind << 32) | value;
+}
+
+static bool watch_(int fd, uint32_t kind, uint32_t value)
+{
+	struct epoll_event event_;
+	memset(&event_, 0, sizeof(event_));
+	event_.events = EPOLLIN;
+	event_.data.u64 = epoll_key_(kind, value);
+	return epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event_) == 0;
+}
+
+static bool hung_up_(ssize_t received)	//From recv() on a non-blocking socket, true if the peer has gone rather than nothing being there yet
+{
+	return received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR);
+}
+
+static void close_state_client_(int fd)
+{
+	for(size_t i = 0; i < state_clients_.size(); i++)
+	{
+		if(state_clients_[i] == fd)	//May already have been dropped earlier in this batch of events
+		{
+			state_clients_.erase(state_clients_.begin() + i);
+			close(fd);	//Also removes it from the epoll set
+			return;
+		}
+	}
+}
+
+static bool send_message_(int fd, const uint8_t *message, size_t length)	//False if the client has to go
+{
+	ssize_t sent_ = send(fd, message, length, MSG_NOSIGNAL | MSG_DONTWAIT);
+	return sent_ == (ssize_t)length;
+}
+
+static size_t encode_state_(const ld2410dSensor *sensor, uint8_t *message)
+{
+	message[0] = LD2410D_MESSAGE_STATE;
+	message[1] = sensor->index;
+	message[2] = sensor->state.targetType;
+	message[3] = sensor->state.movingTargetEnergy;
+	message[4] = sensor->state.stationaryTargetEnergy;
+	message[5] = sensor->connected ? LD2410D_FLAG_CONNECTED : 0;
+	message[6] = sensor->state.movingTargetDistance & 0xFF;
+	message[7] = sensor->state.movingTargetDistance >> 8;
+	message[8] = sensor->state.stationaryTargetDistance & 0xFF;
+	message[9] = sensor->state.stationaryTargetDistance >> 8;
+	message[10] = sensor->state.detectionDistance & 0xFF;
+	message[11] = sensor->state.detectionDistance >> 8;
+	uint32_t now_ = millis();
+	for(uint8_t i = 0; i < 4; i++)
+	{
+		message[12 + i] = now_ >> (8 * i);
+	}
+	return LD2410D_STATE_LENGTH;
+}
+
+static void publish_(ld2410dSensor *sensor)
+{
+	uint8_t message_[LD2410D_STATE_LENGTH];
+	size_t length_ = encode_state_(sensor, message_);
+	sensor->published++;
+	for(size_t i = state_clients_.size(); i > 0; i--)	//Backwards, so dropping a client doesn't skip the next
+	{
+		if(send_message_(state_clients_[i - 1], message_, length_) == false)
+		{
+			clients_dropped_++;
+			close_state_client_(state_clients_[i - 1]);
+		}
+	}
+}
+
+static bool state_changed_(const ld2410Reading &previous, const ld2410Reading &reading)
+{
+	return previous.targetType != reading.targetType ||
+		previous.movingTargetDistance != reading.movingTargetDistance ||
+		previous.movingTargetEnergy != reading.movingTargetEnergy ||
+		previous.stationaryTargetDistance != reading.stationaryTargetDistance ||
+		previous.stationaryTargetEnergy != reading.stationaryTargetEnergy ||
+		previous.detectionDistance != reading.detectionDistance;
+}
+
+static void data_received_(const ld2410Reading &reading, void *context)
+{
+	ld2410dSensor *sensor_ = static_cast<ld2410dSensor *>(context);
+	if(sensor_->reported && sensor_->connected && state_changed_(sensor_->state, reading) == false)
+	{
+		return;
+	}
+	sensor_->state = reading;
+	sensor_->reported = true;
+	sensor_->connected = true;
+	publish_(sensor_);
+}
+
+static bool open_sensor_(ld2410dSensor *sensor, uint32_t baud_rate)
+{
+	sensor->last_attempt = millis();
+	if(sensor->serial.begin(sensor->device, baud_rate) == false)
+	{
+		return false;
+	}
+	if(watch_(sensor->serial.fd(), LD2410D_SENSOR, sensor->index) == false)
+	{
+		sensor->serial.end();
+		return false;
+	}
+	sensor->open = true;
+	fprintf(stderr, "ld2410d: opened %s\n", sensor->device);
+	return true;
+}
+
+static void close_sensor_(ld2410dSensor *sensor)
+{
+	sensor->serial.end();	//Closing removes it from the epoll set
+	sensor->open = false;
+	sensor->reconnects++;
+	fprintf(stderr, "ld2410d: lost %s\n", sensor->device);
+}
+
+static void check_sensors_(uint32_t baud_rate)	//Reopen missing devices and publish any that have gone quiet
+{
+	for(size_t i = 0; i < sensors_.size(); i++)
+	{
+		ld2410dSensor *sensor_ = sensors_[i];
+		if(sensor_->open == false && millis() - sensor_->last_attempt >= LD2410D_RETRY)
+		{
+			open_sensor_(sensor_, baud_rate);
+		}
+		if(sensor_->connected && millis() - sensor_->radar.statistics().lastGoodFrame >= LD2410D_CONNECTED_TIMEOUT)
+		{
+			sensor_->connected = false;
+			publish_(sensor_);
+		}
+	}
+}
+
+static void accept_state_client_(int listener)
+{
+	int fd_ = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+	if(fd_ < 0)
+	{
+		return;
+	}
+	bool ok_ = watch_(fd_, LD2410D_STATE_CLIENT, fd_);
+	for(size_t i = 0; ok_ && i < sensors_.size(); i++)	//Tell it which sensor is which
+	{
+		uint8_t message_[3 + 255];
+		size_t length_ = strlen(sensors_[i]->device);
+		if(length_ > 255)
+		{
+			length_ = 255;
+		}
+		message_[0] = LD2410D_MESSAGE_DEVICE;
+		message_[1] = sensors_[i]->index;
+		message_[2] = length_;
+		memcpy(&message_[3], sensors_[i]->device, length_);
+		ok_ = send_message_(fd_, message_, 3 + length_);
+	}
+	for(size_t i = 0; ok_ && i < sensors_.size(); i++)	//Then where things are now
+	{
+		if(sensors_[i]->reported)
+		{
+			uint8_t message_[LD2410D_STATE_LENGTH];
+			ok_ = send_message_(fd_, message_, encode_state_(sensors_[i], message_));
+		}
+	}
+	if(ok_ == false)
+	{
+		close(fd_);
+		return;
+	}
+	state_clients_.push_back(fd_);
+}
+
+static void append_metric_(std::string &text, const char *name, const char *type, const char *help, uint64_t (*value)(ld2410dSensor *))
+{
+	char line_[512];
+	snprintf(line_, sizeof(line_), "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+	text += line_;
+	for(size_t i = 0; i < sensors_.size(); i++)
+	{
+		snprintf(line_, sizeof(line_), "%s{device=\"%s\"} %llu\n", name, sensors_[i]->device, (unsigned long long)value(sensors_[i]));
+		text += line_;
+	}
+}
+
+static std::string metrics_()
+{
+	std::string text_;
+	append_metric_(text_, "ld2410_up", "gauge", "Whether the sensor has sent a good frame recently.",
+		[](ld2410dSensor *s) -> uint64_t { return s->open && s->connected; });
+	append_metric_(text_, "ld2410_bytes_total", "counter", "Bytes read from the sensor.",
+		[](ld2410dSensor *s) -> uint64_t { return s->radar.statistics().bytesIn; });
+	append_metric_(text_, "ld2410_data_frames_total", "counter", "Normal data frames parsed.",
+		[](ld2410dSensor *s) -> uint64_t { return s->radar.statistics().dataFrames; });
+	append_metric_(text_, "ld2410_engineering_frames_total", "counter", "Engineering mode data frames parsed.",
+		[](ld2410dSensor *s) -> uint64_t { return s->radar.statistics().engineeringFrames; });
+	append_metric_(text_, "ld2410_unknown_frames_total", "counter", "Well formed frames that were not understood.",
+		[](ld2410dSensor *s) -> uint64_t { return s->radar.statistics().unknownFrames; });
+	append_metric_(text_, "ld2410_discarded_bytes_total", "counter", "Bytes skipped while resynchronising.",
+		[](ld2410dSensor *s) -> uint64_t { return s->radar.statistics().bytesDiscarded; });
+	append_metric_(text_, "ld2410_length_errors_total", "counter", "Frames whose footer was not where the length said.",
+		[](ld2410dSensor *s) -> uint64_t { return s->radar.statistics().lengthErrors; });
+	append_metric_(text_, "ld2410_overruns_total", "counter", "Frames too long to be valid.",
+		[](ld2410dSensor *s) -> uint64_t { return s->radar.statistics().overruns; });
+	append_metric_(text_, "ld2410_published_total", "counter", "State changes sent to clients.",
+		[](ld2410dSensor *s) -> uint64_t { return s->published; });
+	append_metric_(text_, "ld2410_reconnects_total", "counter", "Times the device was lost.",
+		[](ld2410dSensor *s) -> uint64_t { return s->reconnects; });
+	append_metric_(text_, "ld2410_target_type", "gauge", "0 none, 1 moving, 2 stationary, 3 both.",
+		[](ld2410dSensor *s) -> uint64_t { return s->state.targetType; });
+	append_metric_(text_, "ld2410_moving_distance_cm", "gauge", "Distance to the moving target.",
+		[](ld2410dSensor *s) -> uint64_t { return s->state.movingTargetDistance; });
+	append_metric_(text_, "ld2410_moving_energy", "gauge", "Energy of the moving target, 0-100.",
+		[](ld2410dSensor *s) -> uint64_t { return s->state.movingTargetEnergy; });
+	append_metric_(text_, "ld2410_stationary_distance_cm", "gauge", "Distance to the stationary target.",
+		[](ld2410dSensor *s) -> uint64_t { return s->state.stationaryTargetDistance; });
+	append_metric_(text_, "ld2410_stationary_energy", "gauge", "Energy of the stationary target, 0-100.",
+		[](ld2410dSensor *s) -> uint64_t { return s->state.stationaryTargetEnergy; });
+	char line_[512];
+	snprintf(line_, sizeof(line_), "# HELP ld2410d_clients Clients connected to the Unix socket.\n# TYPE ld2410d_clients gauge\nld2410d_clients %u\n"
+		"# HELP ld2410d_clients_dropped_total Clients disconnected for not keeping up.\n# TYPE ld2410d_clients_dropped_total counter\nld2410d_clients_dropped_total %u\n",
+		(unsigned int)state_clients_.size(), clients_dropped_);
+	text_ += line_;
+	return text_;
+}
+
+static void close_metrics_client_(int fd)
+{
+	metrics_clients_.erase(fd);
+	close(fd);	//Also removes it from the epoll set
+}
+
+static void accept_metrics_client_(int listener)
+{
+	int fd_ = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+	if(fd_ < 0)
+	{
+		return;
+	}
+	if(watch_(fd_, LD2410D_METRICS_CLIENT, fd_) == false)
+	{
+		close(fd_);
+		return;
+	}
+	metrics_clients_[fd_].accepted = millis();
+}
+
+static void expire_metrics_clients_()	//Close clients that are too slow to ask or to read, so idle connections can't use up the daemon
+{
+	uint32_t now_ = millis();
+	for(std::map<int, ld2410dMetricsClient>::iterator i = metrics_clients_.begin(); i != metrics_clients_.end();)
+	{
+		int fd_ = i->first;
+		uint32_t accepted_ = i->second.accepted;
+		++i;
+		if(now_ - accepted_ >= LD2410D_METRICS_TIMEOUT)
+		{
+			close_metrics_client_(fd_);
+		}
+	}
+}
+
+static void send_metrics_(int fd)	//Send as much of the response as the socket takes, waiting for EPOLLOUT when it is full
+{
+	std::string &response_ = metrics_clients_[fd].response;
+	while(response_.size() > 0)
+	{
+		ssize_t sent_ = send(fd, response_.data(), response_.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+		if(sent_ > 0)
+		{
+			response_.erase(0, sent_);
+		}
+		else if(sent_ < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		else if(sent_ < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+		{
+			struct epoll_event event_;
+			memset(&event_, 0, sizeof(event_));
+			event_.events = EPOLLOUT;
+			event_.data.u64 = epoll_key_(LD2410D_METRICS_CLIENT, fd);
+			if(epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &event_) == 0)
+			{
+				return;
+			}
+			break;
+		}
+		else
+		{
+			break;
+		}
+	}
+	close_metrics_client_(fd);
+}
+
+static void serve_metrics_(int fd)	//Answer any request with the metrics once its headers have arrived, then close
+{
+	ld2410dMetricsClient &client_ = metrics_clients_[fd];
+	if(client_.response.size() > 0)	//Room for more of a response already started
+	{
+		send_metrics_(fd);
+		return;
+	}
+	char request_[1024];
+	ssize_t received_ = recv(fd, request_, sizeof(request_), MSG_DONTWAIT);
+	if(received_ <= 0)
+	{
+		if(hung_up_(received_))
+		{
+			close_metrics_client_(fd);
+		}
+		return;
+	}
+	client_.request.append(request_, received_);
+	if(client_.request.find("\r\n\r\n") == std::string::npos && client_.request.find("\n\n") == std::string::npos)
+	{
+		if(client_.request.size() > LD2410D_METRICS_REQUEST)
+		{
+			close_metrics_client_(fd);
+		}
+		return;	//Wait for the rest, expire_metrics_clients_() closes it if it never comes
+	}
+	std::string body_ = metrics_();
+	char header_[160];
+	int header_length_ = snprintf(header_, sizeof(header_), "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: %u\r\nConnection: close\r\n\r\n", (unsigned int)body_.size());
+	client_.request.clear();
+	client_.response = std::string(header_, header_length_) + body_;
+	send_metrics_(fd);
+}
+
+static int listen_unix_(const char *path)
+{
+	int fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	struct sockaddr_un address_;
+	memset(&address_, 0, sizeof(address_));
+	address_.sun_family = AF_UNIX;
+	if(fd_ < 0 || strlen(path) >= sizeof(address_.sun_path))
+	{
+		return -1;
+	}
+	strcpy(address_.sun_path, path);
+	unlink(path);	//Left over from a previous run
+	if(bind(fd_, (struct sockaddr *)&address_, sizeof(address_)) != 0 || listen(fd_, 16) != 0)
+	{
+		close(fd_);
+		return -1;
+	}
+	return fd_;
+}
+
+static int listen_tcp_(const char *host, uint16_t port)
+{
+	int fd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	int reuse_ = 1;
+	struct sockaddr_in address_;
+	memset(&address_, 0, sizeof(address_));
+	address_.sin_family = AF_INET;
+	address_.sin_port = htons(port);
+	if(fd_ < 0 || inet_pton(AF_INET, host, &address_.sin_addr) != 1)
+	{
+		return -1;
+	}
+	setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &reuse_, sizeof(reuse_));
+	if(bind(fd_, (struct sockaddr *)&address_, sizeof(address_)) != 0 || listen(fd_, 16) != 0)
+	{
+		close(fd_);
+		return -1;
+	}
+	return fd_;
+}
+
+static void stop_(int)
+{
+	running_ = 0;
+}
+
+int main(int argc, char **argv)
+{
+	const char *socket_path_ = "/tmp/ld2410d.sock";
+	const char *metrics_host_ = "127.0.0.1";
+	long metrics_port_ = 9410;
+	uint32_t baud_rate_ = LD2410_DEFAULT_BAUD_RATE;
+	int option_;
+	while((option_ = getopt(argc, argv, "s:m:a:b:")) != -1)
+	{
+		switch(option_)
+		{
+			case 's':
+				socket_path_ = optarg;
+				break;
+			case 'm':
+				metrics_port_ = strtol(optarg, nullptr, 10);
+				break;
+			case 'a':
+				metrics_host_ = optarg;
+				break;
+			case 'b':
+				baud_rate_ = strtoul(optarg, nullptr, 10);
+				break;
+			default:
+				fprintf(stderr, "usage: %s [-s socket] [-m metrics port] [-a metrics address] [-b baud rate] device...\n", argv[0]);
+				return 1;
+		}
+	}
+	if(optind == argc || argc - optind > LD2410D_MAX_SENSORS || metrics_port_ < 0 || metrics_port_ > 65535)
+	{
+		fprintf(stderr, "usage: %s [-s socket] [-m metrics port] [-a metrics address] [-b baud rate] device...\n", argv[0]);
+		return 1;
+	}
+	signal(SIGINT, stop_);
+	signal(SIGTERM, stop_);
+	signal(SIGPIPE, SIG_IGN);
+	epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+	int state_listener_ = listen_unix_(socket_path_);
+	if(epoll_fd_ < 0 || state_listener_ < 0 || watch_(state_listener_, LD2410D_STATE_LISTENER, 0) == false)
+	{
+		fprintf(stderr, "ld2410d: can't listen on %s: %s\n", socket_path_, strerror(errno));
+		return 1;
+	}
+	int metrics_listener_ = -1;
+	if(metrics_port_ > 0)
+	{
+		metrics_listener_ = listen_tcp_(metrics_host_, metrics_port_);
+		if(metrics_listener_ < 0 || watch_(metrics_listener_, LD2410D_METRICS_LISTENER, 0) == false)
+		{
+			fprintf(stderr, "ld2410d: can't listen on %s:%ld: %s\n", metrics_host_, metrics_port_, strerror(errno));
+			return 1;
+		}
+	}
+	for(int i = optind; i < argc; i++)
+	{
+		ld2410dSensor *sensor_ = new ld2410dSensor();
+		sensor_->device = argv[i];
+		sensor_->index = sensors_.size();
+		sensor_->radar.setDataCallback(data_received_, sensor_);	//Only read, no commands are sent so no begin() is needed
+		sensors_.push_back(sensor_);
+		if(open_sensor_(sensor_, baud_rate_) == false)
+		{
+			fprintf(stderr, "ld2410d: can't open %s, will retry: %s\n", sensor_->device, strerror(errno));
+		}
+	}
+	struct epoll_event events_[LD2410D_MAX_EVENTS];
+	while(running_)
+	{
+		int ready_ = epoll_wait(epoll_fd_, events_, LD2410D_MAX_EVENTS, LD2410D_CONNECTED_TIMEOUT / 4);
+		for(int i = 0; i < ready_; i++)
+		{
+			uint32_t kind_ = events_[i].data.u64 >> 32;
+			uint32_t value_ = events_[i].data.u64 & 0xFFFFFFFF;
+			switch(kind_)
+			{
+				case LD2410D_SENSOR:
+					{
+						ld2410dSensor *sensor_ = sensors_[value_];
+						if(sensor_->open == false)
+						{
+							break;
+						}
+						if(events_[i].events & EPOLLIN)
+						{
+							sensor_->radar.readFrom(sensor_->serial);
+						}
+						if(events_[i].events & (EPOLLHUP | EPOLLERR))	//Eg. the adapter was unplugged
+						{
+							close_sensor_(sensor_);
+						}
+					}
+					break;
+				case LD2410D_STATE_LISTENER:
+					accept_state_client_(state_listener_);
+					break;
+				case LD2410D_STATE_CLIENT:	//Clients only listen, anything else is a hang up
+					{
+						char discard_[64];
+						if(hung_up_(recv(value_, discard_, sizeof(discard_), MSG_DONTWAIT)) || (events_[i].events & (EPOLLHUP | EPOLLERR)))
+						{
+							close_state_client_(value_);
+						}
+					}
+					break;
+				case LD2410D_METRICS_LISTENER:
+					accept_metrics_client_(metrics_listener_);
+					break;
+				case LD2410D_METRICS_CLIENT:
+					serve_metrics_(value_);
+					break;
+			}
+		}
+		check_sensors_(baud_rate_);
+		expire_metrics_clients_();
+	}
+	unlink(socket_path_);
+	return 0;
+}
@@ -0,0 +1,148 @@
+/*
+ *	ld2410Async coroutines against a scripted sensor, including one destroyed while it waits for an ACK. Needs C++20. From the
+ *	root of the library...
+ *
+ *	g++ -std=gnu++20 -Isrc -Iextras/tests extras/tests/asyncTest.cpp src/ld2410*.cpp -o asyncTest -lpthread
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#include "ld2410Test.h"
+#include <ld2410Async.h>
+#include <stdlib.h>
+#include <malloc.h>
+#include <new>
+
+void *operator new(size_t size)	//Freed memory is zeroed and never reused, so calling back into a destroyed coroutine crashes rather than quietly working
+{
+	void *memory = malloc(size > 0 ? size : 1);
+	if(memory == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+void operator delete(void *memory) noexcept
+{
+	if(memory != nullptr)
+	{
+		memset(memory, 0, malloc_usable_size(memory));	//Leaked, the test is short
+	}
+}
+
+void operator delete(void *memory, size_t size) noexcept
+{
+	(void)size;
+	operator delete(memory);
+}
+
+static ld2410Coroutine provision(ld2410Async &sensor, uint8_t &steps)	//Counts the commands that succeed, as it goes
+{
+	bool succeeded = co_await sensor.setMaxValues(6, 6, 10);		//Kept in a variable, GCC 12.2 miscompiles co_await in an if condition
+	if(succeeded == false)
+	{
+		co_return;
+	}
+	steps++;
+	succeeded = co_await sensor.setResolution(1);
+	if(succeeded == false)
+	{
+		co_return;
+	}
+	steps++;
+	succeeded = co_await sensor.requestFirmwareVersion();
+	if(succeeded == false)
+	{
+		co_return;
+	}
+	steps++;
+}
+
+static void runsToTheEnd()
+{
+	ld2410TestSensor sensor;
+	ld2410 radar;
+	radar.begin(sensor, false);
+	ld2410Async async(radar);
+	uint8_t steps = 0;
+	ld2410Coroutine job = provision(async, steps);
+	LD2410_CHECK(job.done() == false && steps == 0);				//Waiting for the first ACK
+	uint32_t started = millis();
+	while(job.done() == false && millis() - started < 1000)
+	{
+		radar.readAvailable();
+	}
+	LD2410_CHECK(job.done());
+	LD2410_CHECK(steps == 3);
+	LD2410_CHECK(sensor.maxMovingGate == 6 && sensor.idleTime == 10 && sensor.resolution == 1);
+}
+
+static void destroyedWhileWaiting()	//The command finishes without resuming the destroyed coroutine
+{
+	ld2410TestSensor sensor;
+	ld2410 radar;
+	radar.begin(sensor, false);
+	ld2410Async async(radar);
+	uint8_t steps = 0;
+	sensor.holdAcks = true;
+	{
+		ld2410Coroutine job = provision(async, steps);
+		LD2410_CHECK(job.done() == false);
+		LD2410_CHECK(radar.commandInProgress());
+	}
+	sensor.holdAcks = false;
+	while(radar.commandInProgress())
+	{
+		sensor.releaseAcks();
+		radar.readAvailable();
+	}
+	LD2410_CHECK(radar.commandStatus() == LD2410_COMMAND_SUCCEEDED);
+	LD2410_CHECK(steps == 0);
+	LD2410_CHECK(sensor.maxMovingGate == 6 && sensor.resolution == 0);	//Went no further
+	ld2410Coroutine job = provision(async, steps);					//And the radar is free for the next one
+	while(job.done() == false)
+	{
+		radar.readAvailable();
+	}
+	LD2410_CHECK(steps == 3 && sensor.resolution == 1);
+}
+
+static uint8_t callbacks = 0;
+
+static void countCallback(uint8_t, uint8_t, void *)
+{
+	callbacks++;
+}
+
+static void releaseLeavesOthers()	//Only the matching context is released
+{
+	ld2410TestSensor sensor;
+	ld2410 radar;
+	radar.begin(sensor, false);
+	LD2410_CHECK(radar.submitCommand(LD2410_CMD_SET_RESOLUTION, 1, 0, 0, countCallback, &sensor));
+	radar.releaseCommandCallback(&radar);
+	while(radar.commandInProgress())
+	{
+		radar.readAvailable();
+	}
+	LD2410_CHECK(callbacks == 1);
+	LD2410_CHECK(radar.submitCommand(LD2410_CMD_SET_RESOLUTION, 0, 0, 0, countCallback, &sensor));
+	radar.releaseCommandCallback(&sensor);
+	while(radar.commandInProgress())
+	{
+		radar.readAvailable();
+	}
+	LD2410_CHECK(callbacks == 1);
+	LD2410_CHECK(radar.commandStatus() == LD2410_COMMAND_SUCCEEDED && sensor.resolution == 0);
+}
+
+int main()
+{
+	runsToTheEnd();
+	destroyedWhileWaiting();
+	releaseLeavesOthers();
+	return ld2410TestResult("asyncTest");
+}
@@ -0,0 +1,91 @@
+/*
+ *	Baud rate detection against a scripted sensor, checking the bytes read while detecting are counted, passed to the input
+ *	callback and parsed just as read() would. From the root of the library...
+ *
+ *	g++ -std=gnu++11 -Isrc -Iextras/tests extras/tests/baudTest.cpp src/ld2410*.cpp -o baudTest -lpthread
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#include "ld2410Test.h"
+
+class baudTestSensor : public ld2410TestSensor	{
+
+	public:
+		int available() override										//Sends a frame once the UART is at the default rate
+		{
+			if(ld2410TestSensor::available() == 0 && rate == LD2410_DEFAULT_BAUD_RATE)
+			{
+				sendDataFrame(0x01, 120, 60, 0, 0);
+				rate = 0;
+			}
+			return ld2410TestSensor::available();
+		}
+		uint32_t rate = 0;												//Rate just set, 0 once the frame has been sent
+};
+
+struct baudTestLink {
+	baudTestSensor sensor;
+	uint32_t rates = 0;													//Rates tried
+	uint32_t captured = 0;												//Bytes passed to the input callback
+};
+
+static void changeRate(uint32_t baudRate, void *context)
+{
+	baudTestLink *link = static_cast<baudTestLink *>(context);
+	link->rates++;
+	link->sensor.rate = baudRate;
+}
+
+static void captureInput(const uint8_t *, uint16_t length, void *context)
+{
+	static_cast<baudTestLink *>(context)->captured += length;
+}
+
+static void detected()
+{
+	baudTestLink link;
+	ld2410 radar;
+	radar.setInputCallback(captureInput, &link);
+	const uint8_t stale[] = {0xF8, 0xF7, 0xF6, 0xF5, 0x00};			//The end of a frame at an unknown rate
+	link.sensor.send(stale, sizeof(stale));
+	LD2410_CHECK(radar.begin(link.sensor, changeRate, &link, false));
+	LD2410_CHECK(radar.baudRate() == LD2410_DEFAULT_BAUD_RATE);
+	LD2410_CHECK(link.rates == 1);
+	radar.readAvailable();												//The rest of the frame the header was found in
+	ld2410LinkStatistics statistics = radar.statistics();
+	LD2410_CHECK(statistics.bytesIn == sizeof(stale) + 23);
+	LD2410_CHECK(link.captured == statistics.bytesIn);
+	LD2410_CHECK(statistics.bytesDiscarded == sizeof(stale));
+	LD2410_CHECK(statistics.dataFrames == 1);
+	LD2410_CHECK(radar.movingTargetDistance() == 120);
+}
+
+static void countRate(uint32_t, void *context)	//A sensor that sends nothing at any rate
+{
+	(*static_cast<uint32_t *>(context))++;
+}
+
+static void notDetected()	//Every rate tried, the noise buffered beforehand still counted
+{
+	baudTestLink link;
+	ld2410 radar;
+	radar.begin(link.sensor, false);
+	radar.setInputCallback(captureInput, &link);
+	const uint8_t noise[] = {0x00, 0xF4, 0x7F, 0xFF, 0x12};
+	link.sensor.send(noise, sizeof(noise));
+	LD2410_CHECK(radar.detectBaudRate(countRate, &link.rates, 5) == 0);
+	LD2410_CHECK(link.rates == 8);
+	LD2410_CHECK(radar.baudRate() == 0);
+	LD2410_CHECK(radar.statistics().bytesIn == sizeof(noise));
+	LD2410_CHECK(link.captured == sizeof(noise));
+}
+
+int main()
+{
+	detected();
+	notDetected();
+	return ld2410TestResult("baudTest");
+}
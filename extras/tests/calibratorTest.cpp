@@ -0,0 +1,130 @@
+/*
+ *	ld2410Calibrator against a scripted sensor, checking it waits for a command or transaction of the application's rather than
+ *	joining in or taking it over. From the root of the library...
+ *
+ *	g++ -std=gnu++11 -Isrc -Iextras/tests extras/tests/calibratorTest.cpp src/ld2410*.cpp -o calibratorTest -lpthread
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#include "ld2410Test.h"
+#include <ld2410Calibrator.h>
+
+#define CALIBRATOR_TEST_WINDOW 20										//Collecting time in ms, kept short
+
+static void startCollecting(ld2410TestSensor &sensor, ld2410 &radar, ld2410Calibrator &calibrator, uint8_t frames)
+{
+	LD2410_CHECK(calibrator.begin(CALIBRATOR_TEST_WINDOW, 0.95, 10));
+	while(calibrator.update() == LD2410_CALIBRATION_STARTING)
+	{
+		radar.readAvailable();
+	}
+	LD2410_CHECK(calibrator.state() == LD2410_CALIBRATION_COLLECTING);
+	LD2410_CHECK(sensor.engineeringMode);
+	const uint8_t moving[LD2410_GATES] = {20, 18, 15, 12, 10, 8, 6, 5, 4};
+	const uint8_t stationary[LD2410_GATES] = {5, 5, 30, 25, 20, 15, 10, 10, 10};
+	for(uint8_t i = 0; i < frames; i++)
+	{
+		sensor.sendEngineeringFrame(moving, stationary);
+	}
+	radar.readAvailable();
+	LD2410_CHECK(calibrator.samples() == frames);
+}
+
+static void waitForWindow(ld2410Calibrator &calibrator)	//Updates as the window closes, staying collecting while the sensor is busy
+{
+	uint32_t started = millis();
+	while(millis() - started < 2 * CALIBRATOR_TEST_WINDOW)
+	{
+		calibrator.update();
+	}
+}
+
+static void userTransactionOpen()	//The window closes while the application is building a transaction
+{
+	ld2410TestSensor sensor;
+	ld2410 radar;
+	radar.begin(sensor, false);
+	ld2410Calibrator calibrator(radar);
+	startCollecting(sensor, radar, calibrator, 10);
+	size_t sent = sensor.commands.size();
+	LD2410_CHECK(radar.beginTransaction());
+	LD2410_CHECK(radar.queueMaxValues(6, 6, 10));
+	waitForWindow(calibrator);
+	LD2410_CHECK(calibrator.state() == LD2410_CALIBRATION_COLLECTING);
+	LD2410_CHECK(radar.transactionOpen());							//Left exactly as the application built it
+	LD2410_CHECK(radar.transactionLength() == 1);
+	LD2410_CHECK(sensor.commands.size() == sent);
+	LD2410_CHECK(radar.commitTransaction());
+	const uint8_t user[] = {LD2410_CMD_ENTER_CONFIGURATION, LD2410_CMD_SET_MAX_VALUES, LD2410_CMD_LEAVE_CONFIGURATION};
+	LD2410_CHECK(sensor.commands.size() == sent + sizeof(user) && memcmp(&sensor.commands[sent], user, sizeof(user)) == 0);
+	sent = sensor.commands.size();
+	while(calibrator.update() == LD2410_CALIBRATION_COLLECTING || calibrator.state() == LD2410_CALIBRATION_APPLYING)
+	{
+		radar.readAvailable();
+	}
+	LD2410_CHECK(calibrator.state() == LD2410_CALIBRATION_DONE);
+	LD2410_CHECK(sensor.commands.size() == sent + 3 + LD2410_GATES);	//Its own session, enter, end engineering mode, each gate and leave
+	LD2410_CHECK(sensor.commands[sent + 1] == LD2410_CMD_END_ENGINEERING_MODE);
+	LD2410_CHECK(sensor.engineeringMode == false);
+	LD2410_CHECK(sensor.maxMovingGate == 6 && sensor.idleTime == 10);
+	LD2410_CHECK(calibrator.threshold(LD2410_MOVING, 0) == 30 && sensor.motionSensitivity[0] == 30);
+	LD2410_CHECK(calibrator.threshold(LD2410_STATIONARY, 2) == 40 && sensor.stationarySensitivity[2] == 40);
+}
+
+static void commandInProgress()	//The window closes while a non-blocking command is waiting for its ACK
+{
+	ld2410TestSensor sensor;
+	ld2410 radar;
+	radar.begin(sensor, false);
+	ld2410Calibrator calibrator(radar);
+	startCollecting(sensor, radar, calibrator, 10);
+	sensor.holdAcks = true;
+	LD2410_CHECK(radar.submitCommand(LD2410_CMD_SET_RESOLUTION, 1));
+	waitForWindow(calibrator);
+	LD2410_CHECK(calibrator.state() == LD2410_CALIBRATION_COLLECTING);	//Not failed, still waiting to apply
+	sensor.holdAcks = false;
+	while(radar.commandInProgress())
+	{
+		sensor.releaseAcks();
+		radar.readAvailable();
+	}
+	LD2410_CHECK(radar.commandStatus() == LD2410_COMMAND_SUCCEEDED);
+	while(calibrator.update() == LD2410_CALIBRATION_COLLECTING || calibrator.state() == LD2410_CALIBRATION_APPLYING)
+	{
+		radar.readAvailable();
+	}
+	LD2410_CHECK(calibrator.state() == LD2410_CALIBRATION_DONE);
+	LD2410_CHECK(sensor.engineeringMode == false);
+	LD2410_CHECK(sensor.resolution == 1);
+}
+
+static void tooFewFramesWhileBusy()	//Giving up still has to end engineering mode, once the sensor is free
+{
+	ld2410TestSensor sensor;
+	ld2410 radar;
+	radar.begin(sensor, false);
+	ld2410Calibrator calibrator(radar);
+	startCollecting(sensor, radar, calibrator, 2);
+	LD2410_CHECK(radar.beginTransaction());
+	waitForWindow(calibrator);
+	LD2410_CHECK(calibrator.state() == LD2410_CALIBRATION_COLLECTING);
+	LD2410_CHECK(radar.transactionOpen());
+	radar.cancelTransaction();
+	LD2410_CHECK(calibrator.update() == LD2410_CALIBRATION_FAILED);
+	while(radar.commandInProgress())
+	{
+		radar.readAvailable();
+	}
+	LD2410_CHECK(sensor.engineeringMode == false);
+}
+
+int main()
+{
+	userTransactionOpen();
+	commandInProgress();
+	tooFewFramesWhileBusy();
+	return ld2410TestResult("calibratorTest");
+}
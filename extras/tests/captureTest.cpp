@@ -0,0 +1,217 @@
+/*
+ *	ld2410Capture and ld2410Replay, checking the capture format byte for byte, replaying it as fast as possible and in real time,
+ *	and coping with a capture cut short. From the root of the library...
+ *
+ *	g++ -std=gnu++11 -Isrc -Iextras/tests extras/tests/captureTest.cpp src/ld2410*.cpp -o captureTest -lpthread
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#include "ld2410Test.h"
+#include <ld2410Capture.h>
+
+class captureTestFile : public Stream	{								//A capture held in memory, written then read back
+
+	public:
+		int available() override
+		{
+			return data.size() - position;
+		}
+		int read() override
+		{
+			return position < data.size() ? data[position++] : -1;
+		}
+		int peek() override
+		{
+			return position < data.size() ? data[position] : -1;
+		}
+		size_t write(uint8_t byte) override
+		{
+			data.push_back(byte);
+			return 1;
+		}
+		using Print::write;
+		std::vector<uint8_t> data;
+		size_t position = 0;
+};
+
+static std::vector<uint8_t> replayAll(ld2410Replay &replay)	//Everything the replay releases, as fast as it is read
+{
+	std::vector<uint8_t> bytes;
+	while(replay.finished() == false)
+	{
+		int byte = replay.read();
+		if(byte >= 0)
+		{
+			bytes.push_back(byte);
+		}
+	}
+	return bytes;
+}
+
+static uint32_t varint(const std::vector<uint8_t> &data, size_t &position)
+{
+	uint32_t value = 0;
+	for(uint8_t shift = 0; position < data.size(); shift += 7)
+	{
+		uint8_t byte = data[position++];
+		value |= (uint32_t)(byte & 0x7F) << shift;
+		if((byte & 0x80) == 0)
+		{
+			break;
+		}
+	}
+	return value;
+}
+
+static void format()	//Varint timestamps and lengths, blocks split at LD2410_CAPTURE_BLOCK_LENGTH
+{
+	ld2410 radar;
+	captureTestFile file;
+	ld2410Capture capture;
+	LD2410_CHECK(capture.begin(radar, file));
+	LD2410_CHECK(capture.begin(radar, file) == false);				//Already capturing
+	uint32_t start = micros() + 200;
+	const uint8_t first[] = {0x11, 0x22, 0x33};
+	capture.add(first, sizeof(first), start);
+	capture.add(&first[2], 1, start + LD2410_CAPTURE_RESOLUTION - 1);	//Shares the block's timestamp
+	capture.add(first, 2, start + LD2410_CAPTURE_RESOLUTION);			//Starts a new block
+	capture.add(first, 1, start + LD2410_CAPTURE_RESOLUTION + 300);
+	uint8_t many[150];
+	for(uint8_t i = 0; i < sizeof(many); i++)
+	{
+		many[i] = i;
+	}
+	capture.add(many, sizeof(many), start + LD2410_CAPTURE_RESOLUTION + 200000);	//Over two full blocks
+	capture.end();
+	LD2410_CHECK(capture.bytes() == 4 + 3 + sizeof(many));
+	LD2410_CHECK(capture.blocks() == 5);
+	LD2410_CHECK(capture.dropped() == 0);
+	const uint8_t header[] = {'L', 'D', 'C', LD2410_CAPTURE_VERSION};
+	LD2410_CHECK(file.data.size() > sizeof(header) && memcmp(file.data.data(), header, sizeof(header)) == 0);
+	size_t position = sizeof(header);
+	uint32_t delta = varint(file.data, position);						//From begin(), so only roughly known
+	LD2410_CHECK(delta >= 200 && delta < 1000000);
+	const uint8_t expected[] = {
+		0x04, 0x11, 0x22, 0x33, 0x33,									//Length 4
+		0xE8, 0x07, 0x03, 0x11, 0x22, 0x11,								//1000us later, length 3
+		0xC0, 0x9A, 0x0C, LD2410_CAPTURE_BLOCK_LENGTH					//200000us later as three varint bytes, a full block
+	};
+	LD2410_CHECK(file.data.size() >= position + sizeof(expected) && memcmp(&file.data[position], expected, sizeof(expected)) == 0);
+	position += sizeof(expected) + LD2410_CAPTURE_BLOCK_LENGTH;
+	LD2410_CHECK(file.data.size() > position + 1 && file.data[position] == 0x00 && file.data[position + 1] == LD2410_CAPTURE_BLOCK_LENGTH);	//The rest arrived at the same time
+	position += 2 + LD2410_CAPTURE_BLOCK_LENGTH;
+	LD2410_CHECK(file.data.size() > position + 1 && file.data[position] == 0x00 && file.data[position + 1] == sizeof(many) - 2 * LD2410_CAPTURE_BLOCK_LENGTH);
+	position += 2 + sizeof(many) - 2 * LD2410_CAPTURE_BLOCK_LENGTH;
+	LD2410_CHECK(position == file.data.size());
+	LD2410_CHECK(memcmp(&file.data[position - 22], &many[128], 22) == 0);
+	ld2410Replay replay;
+	LD2410_CHECK(replay.begin(file, false));
+	std::vector<uint8_t> played = replayAll(replay);
+	std::vector<uint8_t> sent = {0x11, 0x22, 0x33, 0x33, 0x11, 0x22, 0x11};
+	sent.insert(sent.end(), many, many + sizeof(many));
+	LD2410_CHECK(played == sent);
+	LD2410_CHECK(replay.bytes() == sent.size());
+}
+
+static void roundTrip()	//A session with a scripted sensor captured, then replayed into another ld2410
+{
+	ld2410TestSensor sensor;
+	ld2410 radar;
+	radar.begin(sensor, false);
+	captureTestFile file;
+	ld2410Capture capture;
+	LD2410_CHECK(capture.begin(radar, file));
+	for(uint16_t i = 0; i < 40; i++)
+	{
+		sensor.sendDataFrame(0x01, 100 + i, 50, 0, 0);
+		radar.readAvailable();
+		if(i % 8 == 0)
+		{
+			delay(LD2410_CAPTURE_RESOLUTION / 1000 + 1);			//Some frames in blocks of their own
+		}
+	}
+	capture.end();
+	LD2410_CHECK(capture.bytes() == radar.statistics().bytesIn);
+	LD2410_CHECK(capture.blocks() > 5);
+	ld2410Replay replay;
+	LD2410_CHECK(replay.begin(file, false));
+	ld2410 replayed;
+	replayed.begin(replay, false);
+	while(replay.finished() == false)
+	{
+		replayed.readAvailable();
+	}
+	LD2410_CHECK(replayed.statistics().dataFrames == 40);
+	LD2410_CHECK(replayed.statistics().bytesIn == radar.statistics().bytesIn);
+	LD2410_CHECK(replayed.movingTargetDistance() == 139);
+	LD2410_CHECK(replay.write(0x55) == 1);							//Commands are thrown away
+}
+
+static void realTime()	//Each block is held back until its time has come
+{
+	captureTestFile file;
+	const uint8_t capture[] = {'L', 'D', 'C', LD2410_CAPTURE_VERSION,
+		0x00, 0x03, 0x01, 0x02, 0x03,									//Straight away
+		0xB0, 0xEA, 0x01, 0x02, 0x04, 0x05,								//30000us later
+		0x00, 0x00,														//An empty block, skipped
+		0x00, 0x01, 0x06												//At the same time
+	};
+	file.data.assign(capture, capture + sizeof(capture));
+	ld2410Replay replay;
+	uint32_t started = micros();
+	LD2410_CHECK(replay.begin(file));
+	LD2410_CHECK(replay.available() == 3);
+	LD2410_CHECK(replay.read() == 1 && replay.read() == 2 && replay.read() == 3);
+	LD2410_CHECK(replay.available() == 0 && replay.read() == -1 && replay.peek() == -1);
+	LD2410_CHECK(replay.finished() == false);
+	while(replay.available() == 0 && micros() - started < 1000000)
+	{
+		delay(1);
+	}
+	LD2410_CHECK(micros() - started >= 30000);
+	LD2410_CHECK(replay.available() == 2 && replay.peek() == 4);
+	LD2410_CHECK(replay.read() == 4 && replay.read() == 5);
+	LD2410_CHECK(replay.read() == 6);
+	LD2410_CHECK(replay.finished());
+	LD2410_CHECK(replay.bytes() == 6);
+}
+
+static void truncated()	//A capture cut short, eg. by a power cut, plays what there is then finishes
+{
+	captureTestFile file;
+	const uint8_t capture[] = {'L', 'D', 'C', LD2410_CAPTURE_VERSION,
+		0x00, 0x02, 0x01, 0x02,
+		0x00, 0x0A, 0x03, 0x04, 0x05										//Says ten bytes, only three arrived
+	};
+	file.data.assign(capture, capture + sizeof(capture));
+	ld2410Replay replay;
+	LD2410_CHECK(replay.begin(file, false));
+	std::vector<uint8_t> played = replayAll(replay);
+	LD2410_CHECK(played.size() == 5 && played[0] == 1 && played[4] == 5);
+	LD2410_CHECK(replay.finished() && replay.read() == -1);
+	file.data.assign(capture, capture + 9);							//Cut inside a block header
+	file.position = 0;
+	LD2410_CHECK(replay.begin(file, false));
+	played = replayAll(replay);
+	LD2410_CHECK(played.size() == 2 && replay.finished());
+	file.data.assign(capture, capture + 3);							//Not even the whole file header
+	file.position = 0;
+	LD2410_CHECK(replay.begin(file, false) == false);
+	LD2410_CHECK(replay.finished() && replay.available() == 0);
+	const uint8_t wrongVersion[] = {'L', 'D', 'C', LD2410_CAPTURE_VERSION + 1, 0x00, 0x01, 0x01};
+	file.data.assign(wrongVersion, wrongVersion + sizeof(wrongVersion));
+	file.position = 0;
+	LD2410_CHECK(replay.begin(file, false) == false);
+}
+
+int main()
+{
+	format();
+	roundTrip();
+	realTime();
+	truncated();
+	return ld2410TestResult("captureTest");
+}
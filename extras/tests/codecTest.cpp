@@ -0,0 +1,185 @@
+/*
+ *	ld2410Codec on its own, encoding every command and decoding data and ACK frames byte for byte. From the root of the library...
+ *
+ *	g++ -std=gnu++11 -Isrc -Iextras/tests extras/tests/codecTest.cpp src/ld2410*.cpp -o codecTest -lpthread
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#include "ld2410Test.h"
+
+static bool encodesAs(uint8_t command, uint16_t value0, uint16_t value1, uint16_t value2, const uint8_t *expected, uint8_t length)
+{
+	uint8_t frame[LD2410_MAX_COMMAND_LENGTH];
+	memset(frame, 0xEE, sizeof(frame));
+	return ld2410Codec::encodeCommand(frame, command, value0, value1, value2) == length && memcmp(frame, expected, length) == 0;
+}
+
+template<class Frame> static bool compiledAs(const uint8_t *expected)	//A frame built at compile time matches the encoder
+{
+	uint8_t frame[LD2410_MAX_COMMAND_LENGTH];
+	ld2410Codec::copyFrame(frame, Frame::frame, Frame::length);
+	return memcmp(frame, expected, Frame::length) == 0;
+}
+
+static void encodeWithParameters()	//0x60 and 0x64, three parameter words each with a 32-bit value
+{
+	const uint8_t maxValues[] = {0xFD, 0xFC, 0xFB, 0xFA, 0x14, 0x00, 0x60, 0x00,
+		0x00, 0x00, 0x06, 0x00, 0x00, 0x00,
+		0x01, 0x00, 0x05, 0x00, 0x00, 0x00,
+		0x02, 0x00, 0x2C, 0x01, 0x00, 0x00,
+		0x04, 0x03, 0x02, 0x01};
+	LD2410_CHECK(sizeof(maxValues) == LD2410_MAX_COMMAND_LENGTH);
+	LD2410_CHECK(encodesAs(LD2410_CMD_SET_MAX_VALUES, 6, 5, 300, maxValues, sizeof(maxValues)));
+	const uint8_t allGates[] = {0xFD, 0xFC, 0xFB, 0xFA, 0x14, 0x00, 0x64, 0x00,
+		0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00,
+		0x01, 0x00, 0x28, 0x00, 0x00, 0x00,
+		0x02, 0x00, 0x1E, 0x00, 0x00, 0x00,
+		0x04, 0x03, 0x02, 0x01};
+	LD2410_CHECK(encodesAs(LD2410_CMD_SET_GATE_SENSITIVITY, 0xFFFF, 40, 30, allGates, sizeof(allGates)));
+	const uint8_t oneGate[] = {0xFD, 0xFC, 0xFB, 0xFA, 0x14, 0x00, 0x64, 0x00,
+		0x00, 0x00, 0x03, 0x00, 0x00, 0x00,
+		0x01, 0x00, 0x64, 0x00, 0x00, 0x00,
+		0x02, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x04, 0x03, 0x02, 0x01};
+	LD2410_CHECK(encodesAs(LD2410_CMD_SET_GATE_SENSITIVITY, 3, 100, 0, oneGate, sizeof(oneGate)));
+}
+
+static void encodeWithValue()	//One 16-bit value, fixed or given
+{
+	const uint8_t enter[] = {0xFD, 0xFC, 0xFB, 0xFA, 0x04, 0x00, 0xFF, 0x00, 0x01, 0x00, 0x04, 0x03, 0x02, 0x01};
+	LD2410_CHECK(encodesAs(LD2410_CMD_ENTER_CONFIGURATION, 0, 0, 0, enter, sizeof(enter)));	//Always 1, whatever is passed
+	LD2410_CHECK(encodesAs(LD2410_CMD_ENTER_CONFIGURATION, 7, 0, 0, enter, sizeof(enter)));
+	LD2410_CHECK((compiledAs<ld2410ValueCommandFrame<LD2410_CMD_ENTER_CONFIGURATION, 0x0001> >(enter)));
+	const uint8_t mac[] = {0xFD, 0xFC, 0xFB, 0xFA, 0x04, 0x00, 0xA5, 0x00, 0x01, 0x00, 0x04, 0x03, 0x02, 0x01};
+	LD2410_CHECK(encodesAs(LD2410_CMD_GET_MAC, 0, 0, 0, mac, sizeof(mac)));
+	LD2410_CHECK((compiledAs<ld2410ValueCommandFrame<LD2410_CMD_GET_MAC, 0x0001> >(mac)));
+	const uint8_t resolution[] = {0xFD, 0xFC, 0xFB, 0xFA, 0x04, 0x00, 0xAA, 0x00, 0x01, 0x00, 0x04, 0x03, 0x02, 0x01};
+	LD2410_CHECK(encodesAs(LD2410_CMD_SET_RESOLUTION, 1, 0, 0, resolution, sizeof(resolution)));
+	LD2410_CHECK((compiledAs<ld2410ValueCommandFrame<LD2410_CMD_SET_RESOLUTION, 1> >(resolution)));
+	const uint8_t bluetooth[] = {0xFD, 0xFC, 0xFB, 0xFA, 0x04, 0x00, 0xA4, 0x00, 0x00, 0x00, 0x04, 0x03, 0x02, 0x01};
+	LD2410_CHECK(encodesAs(LD2410_CMD_SET_BLUETOOTH, 0, 0, 0, bluetooth, sizeof(bluetooth)));
+	LD2410_CHECK((compiledAs<ld2410ValueCommandFrame<LD2410_CMD_SET_BLUETOOTH, 0> >(bluetooth)));
+	const uint8_t baudRate[] = {0xFD, 0xFC, 0xFB, 0xFA, 0x04, 0x00, 0xA1, 0x00, 0x07, 0x00, 0x04, 0x03, 0x02, 0x01};
+	LD2410_CHECK(encodesAs(LD2410_CMD_SET_BAUD_RATE, 7, 0, 0, baudRate, sizeof(baudRate)));
+	LD2410_CHECK((compiledAs<ld2410ValueCommandFrame<LD2410_CMD_SET_BAUD_RATE, 7> >(baudRate)));
+}
+
+static void encodeWithoutValue()	//Every other opcode, values ignored
+{
+	const uint8_t commands[] = {LD2410_CMD_READ_CONFIGURATION, LD2410_CMD_START_ENGINEERING_MODE, LD2410_CMD_END_ENGINEERING_MODE,
+		LD2410_CMD_READ_FIRMWARE_VERSION, LD2410_CMD_FACTORY_RESET, LD2410_CMD_RESTART, LD2410_CMD_READ_RESOLUTION,
+		LD2410_CMD_LEAVE_CONFIGURATION};
+	for(uint8_t command : commands)
+	{
+		const uint8_t expected[] = {0xFD, 0xFC, 0xFB, 0xFA, 0x02, 0x00, command, 0x00, 0x04, 0x03, 0x02, 0x01};
+		if(LD2410_CHECK(encodesAs(command, 1, 2, 3, expected, sizeof(expected))) == false)
+		{
+			fprintf(stderr, "  opcode 0x%02X\n", command);
+		}
+	}
+	const uint8_t leave[] = {0xFD, 0xFC, 0xFB, 0xFA, 0x02, 0x00, 0xFE, 0x00, 0x04, 0x03, 0x02, 0x01};
+	LD2410_CHECK(compiledAs<ld2410CommandFrame<LD2410_CMD_LEAVE_CONFIGURATION> >(leave));
+	LD2410_CHECK(ld2410CommandFrame<LD2410_CMD_LEAVE_CONFIGURATION>::length == sizeof(leave));
+	const uint8_t restart[] = {0xFD, 0xFC, 0xFB, 0xFA, 0x02, 0x00, 0xA3, 0x00, 0x04, 0x03, 0x02, 0x01};
+	LD2410_CHECK(compiledAs<ld2410CommandFrame<LD2410_CMD_RESTART> >(restart));
+}
+
+static void decodeDataFrames()
+{
+	const uint8_t normal[] = {0xF4, 0xF3, 0xF2, 0xF1, 0x0D, 0x00, 0x02, 0xAA, 0x03, 0x23, 0x01, 0x32, 0x00, 0x00, 0x28, 0x96, 0x00,
+		0x55, 0x00, 0xF8, 0xF7, 0xF6, 0xF5};
+	ld2410Reading reading;
+	memset(&reading, 0xEE, sizeof(reading));
+	LD2410_CHECK(ld2410Codec::decodeData(normal, sizeof(normal), reading) == LD2410_DECODE_OK);
+	LD2410_CHECK(reading.targetType == 0x03);
+	LD2410_CHECK(reading.stationaryTargetDistance == 0x0123);			//As the library has always reported them
+	LD2410_CHECK(reading.movingTargetEnergy == 50);
+	LD2410_CHECK(reading.stationaryTargetEnergy == 40);
+	LD2410_CHECK(reading.movingTargetDistance == 150 && reading.detectionDistance == 150);
+	LD2410_CHECK(reading.engineeringData == false);
+	LD2410_CHECK(reading.movingGateEnergy[0] == 0 && reading.stationaryGateEnergy[LD2410_GATES - 1] == 0);
+	const uint8_t engineering[] = {0xF4, 0xF3, 0xF2, 0xF1, 0x23, 0x00, 0x01, 0xAA, 0x03, 0x1E, 0x00, 0x3C, 0x2C, 0x01, 0x39, 0x90, 0x01,
+		0x08, 0x08,
+		10, 11, 12, 13, 14, 15, 16, 17, 18,
+		20, 21, 22, 23, 24, 25, 26, 27, 28,
+		0x03, 0x05, 0x55, 0x00, 0xF8, 0xF7, 0xF6, 0xF5};
+	LD2410_CHECK(ld2410Codec::decodeData(engineering, sizeof(engineering), reading) == LD2410_DECODE_OK);
+	LD2410_CHECK(reading.targetType == 0x03);
+	LD2410_CHECK(reading.movingTargetDistance == 30 && reading.movingTargetEnergy == 60);
+	LD2410_CHECK(reading.stationaryTargetDistance == 300 && reading.stationaryTargetEnergy == 57);
+	LD2410_CHECK(reading.detectionDistance == 400);
+	LD2410_CHECK(reading.engineeringData);
+	LD2410_CHECK(reading.movingGateEnergy[0] == 10 && reading.movingGateEnergy[8] == 18);
+	LD2410_CHECK(reading.stationaryGateEnergy[0] == 20 && reading.stationaryGateEnergy[8] == 28);
+	LD2410_CHECK(ld2410Codec::decodeData(normal, sizeof(normal) - 1, reading) == LD2410_DECODE_BAD_LENGTH);	//Length field disagrees
+	LD2410_CHECK(ld2410Codec::decodeData(engineering, sizeof(engineering) + 1, reading) == LD2410_DECODE_BAD_LENGTH);
+	LD2410_CHECK(ld2410Codec::decodeData(normal, 8, reading) == LD2410_DECODE_BAD_LENGTH);	//Too short to hold a length
+	uint8_t unknown[sizeof(normal)];
+	memcpy(unknown, normal, sizeof(normal));
+	unknown[6] = 0x03;													//A data type it doesn't know
+	LD2410_CHECK(ld2410Codec::decodeData(unknown, sizeof(unknown), reading) == LD2410_DECODE_UNKNOWN);
+	memcpy(unknown, normal, sizeof(normal));
+	unknown[17] = 0x00;													//Tail byte missing
+	LD2410_CHECK(ld2410Codec::decodeData(unknown, sizeof(unknown), reading) == LD2410_DECODE_UNKNOWN);
+}
+
+static void decodeAckFrames()	//Status, payload and each typed decoder
+{
+	const uint8_t firmware[] = {0xFD, 0xFC, 0xFB, 0xFA, 0x0C, 0x00, 0xA0, 0x01, 0x00, 0x00,
+		0x00, 0x01, 0x02, 0x01, 0x16, 0x24, 0x06, 0x22, 0x04, 0x03, 0x02, 0x01};
+	ld2410Ack ack;
+	LD2410_CHECK(ld2410Codec::decodeAck(firmware, sizeof(firmware), ack));
+	LD2410_CHECK(ack.command == LD2410_CMD_READ_FIRMWARE_VERSION && ack.success);
+	LD2410_CHECK(ack.dataLength == 12 && ack.payloadLength == 8 && ack.payload == &firmware[10]);
+	ld2410FirmwareVersion version;
+	LD2410_CHECK(ld2410Codec::decodeFirmwareVersion(ack, version));
+	LD2410_CHECK(version.major == 1 && version.minor == 2 && version.bugfix == 0x22062416);
+	uint8_t mac[6];
+	LD2410_CHECK(ld2410Codec::decodeMac(ack, mac) == false);			//Not a MAC ACK
+	const uint8_t configuration[] = {0xFD, 0xFC, 0xFB, 0xFA, 0x1C, 0x00, 0x61, 0x01, 0x00, 0x00,
+		0xAA, 0x08, 0x07, 0x06,
+		50, 50, 40, 30, 20, 15, 15, 15, 15,
+		0, 0, 40, 40, 30, 30, 20, 20, 20,
+		0x2C, 0x01, 0x04, 0x03, 0x02, 0x01};
+	LD2410_CHECK(ld2410Codec::decodeAck(configuration, sizeof(configuration), ack));
+	ld2410Configuration decoded;
+	LD2410_CHECK(ld2410Codec::decodeConfiguration(ack, decoded));
+	LD2410_CHECK(decoded.maxGate == 8 && decoded.maxMovingGate == 7 && decoded.maxStationaryGate == 6);
+	LD2410_CHECK(decoded.motionSensitivity[0] == 50 && decoded.motionSensitivity[8] == 15);
+	LD2410_CHECK(decoded.stationarySensitivity[0] == 0 && decoded.stationarySensitivity[2] == 40 && decoded.stationarySensitivity[8] == 20);
+	LD2410_CHECK(decoded.idleTime == 300);
+	LD2410_CHECK(ld2410Codec::decodeFirmwareVersion(ack, version) == false);
+	const uint8_t macAck[] = {0xFD, 0xFC, 0xFB, 0xFA, 0x0A, 0x00, 0xA5, 0x01, 0x00, 0x00,
+		0x8F, 0x27, 0x2E, 0xB8, 0x0F, 0x65, 0x04, 0x03, 0x02, 0x01};
+	LD2410_CHECK(ld2410Codec::decodeAck(macAck, sizeof(macAck), ack));
+	LD2410_CHECK(ld2410Codec::decodeMac(ack, mac));
+	const uint8_t expectedMac[] = {0x8F, 0x27, 0x2E, 0xB8, 0x0F, 0x65};
+	LD2410_CHECK(memcmp(mac, expectedMac, sizeof(mac)) == 0);
+	const uint8_t resolutionAck[] = {0xFD, 0xFC, 0xFB, 0xFA, 0x06, 0x00, 0xAB, 0x01, 0x00, 0x00, 0x01, 0x00, 0x04, 0x03, 0x02, 0x01};
+	LD2410_CHECK(ld2410Codec::decodeAck(resolutionAck, sizeof(resolutionAck), ack));
+	uint8_t resolution = 0;
+	LD2410_CHECK(ld2410Codec::decodeResolution(ack, resolution) && resolution == 1);
+	LD2410_CHECK(ld2410Codec::decodeConfiguration(ack, decoded) == false);
+	const uint8_t failed[] = {0xFD, 0xFC, 0xFB, 0xFA, 0x04, 0x00, 0x64, 0x01, 0x01, 0x00, 0x04, 0x03, 0x02, 0x01};
+	LD2410_CHECK(ld2410Codec::decodeAck(failed, sizeof(failed), ack));
+	LD2410_CHECK(ack.command == LD2410_CMD_SET_GATE_SENSITIVITY && ack.success == false && ack.payloadLength == 0);
+	const uint8_t noStatus[] = {0xFD, 0xFC, 0xFB, 0xFA, 0x02, 0x00, 0x64, 0x01, 0x04, 0x03, 0x02, 0x01};
+	LD2410_CHECK(ld2410Codec::decodeAck(noStatus, sizeof(noStatus), ack) == false);	//Too short to carry a status
+	LD2410_CHECK(ld2410Codec::decodeAck(failed, sizeof(failed) - 1, ack) == false);
+	const uint8_t shortFirmware[] = {0xFD, 0xFC, 0xFB, 0xFA, 0x06, 0x00, 0xA0, 0x01, 0x00, 0x00, 0x00, 0x01, 0x04, 0x03, 0x02, 0x01};
+	LD2410_CHECK(ld2410Codec::decodeAck(shortFirmware, sizeof(shortFirmware), ack));
+	LD2410_CHECK(ld2410Codec::decodeFirmwareVersion(ack, version) == false);	//Payload too short for a version
+}
+
+int main()
+{
+	encodeWithParameters();
+	encodeWithValue();
+	encodeWithoutValue();
+	decodeDataFrames();
+	decodeAckFrames();
+	return ld2410TestResult("codecTest");
+}
@@ -0,0 +1,164 @@
+/*
+ *	feed() with buffers handed over directly, as a UART driver would, checking frames are assembled however the bytes are split
+ *	and that feeding never writes to the UART or finishes a command. From the root of the library...
+ *
+ *	g++ -std=gnu++11 -Isrc -Iextras/tests extras/tests/feedTest.cpp src/ld2410*.cpp -o feedTest -lpthread
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#include "ld2410Test.h"
+
+static std::vector<uint8_t> sent(ld2410TestSensor &sensor)	//Everything the scripted sensor has sent, to be fed in
+{
+	std::vector<uint8_t> bytes;
+	while(sensor.available() > 0)
+	{
+		bytes.push_back(sensor.read());
+	}
+	return bytes;
+}
+
+static std::vector<uint8_t> dataFrame(uint16_t movingDistance)
+{
+	ld2410TestSensor sensor;
+	sensor.sendDataFrame(0x01, movingDistance, 50, 0, 0);
+	return sent(sensor);
+}
+
+static void countFrame(const ld2410Reading &reading, void *context)
+{
+	static_cast<std::vector<uint16_t> *>(context)->push_back(reading.movingTargetDistance);
+}
+
+static void splitAcrossCalls()	//One byte at a time, then in two uneven pieces
+{
+	ld2410 radar;
+	std::vector<uint16_t> distances;
+	radar.setDataCallback(countFrame, &distances);
+	std::vector<uint8_t> frame = dataFrame(111);
+	uint16_t decoded = 0;
+	for(size_t i = 0; i < frame.size(); i++)
+	{
+		decoded += radar.feed(&frame[i], 1);
+		LD2410_CHECK(distances.size() == (i + 1 == frame.size() ? 1U : 0U));	//Only once the last byte is in
+	}
+	LD2410_CHECK(decoded == 1);
+	frame = dataFrame(222);
+	LD2410_CHECK(radar.feed(frame.data(), 5) == 0);					//Part way through the length
+	LD2410_CHECK(radar.feed(&frame[5], frame.size() - 5) == 1);
+	LD2410_CHECK(distances.size() == 2 && distances[0] == 111 && distances[1] == 222);
+	LD2410_CHECK(radar.statistics().bytesIn == 2 * frame.size());
+	LD2410_CHECK(radar.statistics().bytesDiscarded == 0);
+}
+
+static void wrappingTheRing()	//Frames that straddle the end of the ring
+{
+	ld2410 radar;
+	std::vector<uint16_t> distances;
+	radar.setDataCallback(countFrame, &distances);
+	std::vector<uint8_t> frame = dataFrame(0);
+	uint16_t frames = 2 * LD2410_RING_BUFFER_LENGTH / frame.size() + 2;	//Round the ring more than twice, so some frames wrap
+	for(uint16_t i = 0; i < frames; i++)
+	{
+		frame = dataFrame(300 + i);
+		LD2410_CHECK(radar.feed(frame.data(), 7) == 0);				//Uneven pieces, so the ring is left at different places
+		LD2410_CHECK(radar.feed(&frame[7], frame.size() - 7) == 1);
+	}
+	LD2410_CHECK(distances.size() == frames);
+	bool inOrder = true;
+	for(uint16_t i = 0; i < distances.size(); i++)
+	{
+		inOrder = inOrder && distances[i] == 300 + i;
+	}
+	LD2410_CHECK(inOrder);
+	LD2410_CHECK(radar.statistics().dataFrames == frames && radar.statistics().bytesDiscarded == 0);
+}
+
+static void longerThanTheRing()	//A single buffer holding many frames, with noise between them
+{
+	ld2410 radar;
+	std::vector<uint16_t> distances;
+	radar.setDataCallback(countFrame, &distances);
+	std::vector<uint8_t> buffer;
+	const uint8_t noise[] = {0x00, 0xF4, 0xF3, 0x11, 0xFD};
+	for(uint16_t i = 0; i < 20; i++)
+	{
+		std::vector<uint8_t> frame = dataFrame(400 + i);
+		buffer.insert(buffer.end(), frame.begin(), frame.end());
+		if(i % 3 == 0)
+		{
+			buffer.insert(buffer.end(), noise, noise + sizeof(noise));
+		}
+	}
+	LD2410_CHECK(buffer.size() > 4 * LD2410_RING_BUFFER_LENGTH);
+	LD2410_CHECK(radar.feed(buffer.data(), buffer.size()) == 20);
+	LD2410_CHECK(distances.size() == 20 && distances.front() == 400 && distances.back() == 419);
+	LD2410_CHECK(radar.statistics().bytesIn == buffer.size());
+	LD2410_CHECK(radar.statistics().bytesDiscarded == 7 * sizeof(noise));
+}
+
+static void hugeLength()	//A length near 0xFFFF after a good frame is discarded, not wrapped round to a frame that never moves on
+{
+	ld2410 radar;
+	std::vector<uint16_t> distances;
+	radar.setDataCallback(countFrame, &distances);
+	std::vector<uint8_t> buffer = dataFrame(500);
+	for(uint16_t length = 0xFFF6; length != 0; length++)
+	{
+		const uint8_t header[] = {0xF4, 0xF3, 0xF2, 0xF1, (uint8_t)(length & 0xFF), (uint8_t)(length >> 8)};
+		buffer.insert(buffer.end(), header, header + sizeof(header));
+	}
+	std::vector<uint8_t> frame = dataFrame(501);
+	buffer.insert(buffer.end(), frame.begin(), frame.end());
+	LD2410_CHECK(radar.feed(buffer.data(), buffer.size()) == 2);
+	LD2410_CHECK(distances.size() == 2 && distances[0] == 500 && distances[1] == 501);
+	LD2410_CHECK(radar.statistics().overruns == 10);
+	const uint8_t alone[] = {0xF4, 0xF3, 0xF2, 0xF1, 0xF6, 0xFF};	//Straight after the good frame, on its own
+	frame = dataFrame(502);
+	LD2410_CHECK(radar.feed(frame.data(), frame.size()) == 1);
+	LD2410_CHECK(radar.feed(alone, sizeof(alone)) == 0);
+	LD2410_CHECK(radar.feed(frame.data(), frame.size()) == 1);
+	LD2410_CHECK(distances.size() == 4);
+}
+
+static void commandFinished(uint8_t, uint8_t, void *context)
+{
+	(*static_cast<uint8_t *>(context))++;
+}
+
+static void commandsOnlyMoveOnInRead()	//ACKs fed in are acted on by read(), feed() never writes to the UART
+{
+	ld2410TestSensor sensor;
+	ld2410 radar;
+	radar.begin(sensor, false);
+	uint8_t finished = 0;
+	LD2410_CHECK(radar.submitCommand(LD2410_CMD_SET_RESOLUTION, 1, 0, 0, commandFinished, &finished));
+	for(uint8_t step = 0; step < 3; step++)							//Enter, set resolution and leave
+	{
+		size_t written = sensor.commands.size();
+		std::vector<uint8_t> ack = sent(sensor);
+		LD2410_CHECK(radar.feed(ack.data(), ack.size()) == 1);
+		LD2410_CHECK(sensor.commands.size() == written);			//Nothing sent from inside feed()
+		LD2410_CHECK(radar.commandInProgress() && finished == 0);
+		radar.read();
+	}
+	LD2410_CHECK(radar.commandInProgress() == false);
+	LD2410_CHECK(finished == 1);
+	LD2410_CHECK(radar.commandStatus() == LD2410_COMMAND_SUCCEEDED);
+	LD2410_CHECK(sensor.resolution == 1);
+	const uint8_t expected[] = {LD2410_CMD_ENTER_CONFIGURATION, LD2410_CMD_SET_RESOLUTION, LD2410_CMD_LEAVE_CONFIGURATION};
+	LD2410_CHECK(sensor.commands.size() == sizeof(expected) && memcmp(sensor.commands.data(), expected, sizeof(expected)) == 0);
+}
+
+int main()
+{
+	splitAcrossCalls();
+	wrappingTheRing();
+	longerThanTheRing();
+	hugeLength();
+	commandsOnlyMoveOnInRead();
+	return ld2410TestResult("feedTest");
+}
@@ -0,0 +1,128 @@
+/*
+ *	ld2410GateStatistics fed known energies, checking the minimum, maximum, mean, variance and EWMA of each gate and that frames
+ *	without gate energies are ignored. From the root of the library...
+ *
+ *	g++ -std=gnu++11 -Isrc -Iextras/tests extras/tests/gateStatisticsTest.cpp src/ld2410*.cpp -o gateStatisticsTest -lpthread
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#include "ld2410Test.h"
+#include <ld2410GateStatistics.h>
+#include <math.h>
+
+static const uint8_t series[] = {2, 4, 4, 4, 5, 5, 7, 9};				//Mean 5, sample variance 32/7
+static const float ewmas[] = {2, 3, 3.5, 3.75, 4.375, 4.6875, 5.84375, 7.421875};	//With a weight of a half, exact in float
+
+static bool near(float value, float expected)
+{
+	return fabsf(value - expected) < 0.0001f;
+}
+
+static void fill(uint8_t value, uint8_t *moving, uint8_t *stationary)	//Each gate offset by its number, stationary mirrored from 100
+{
+	for(uint8_t gate = 0; gate < LD2410_GATES; gate++)
+	{
+		moving[gate] = value + gate;
+		stationary[gate] = 100 - value - gate;
+	}
+}
+
+static void knownSeries()
+{
+	ld2410GateStatistics statistics(0.5);
+	uint8_t moving[LD2410_GATES];
+	uint8_t stationary[LD2410_GATES];
+	bool ewmaMatches = true;
+	for(uint8_t i = 0; i < sizeof(series); i++)
+	{
+		fill(series[i], moving, stationary);
+		statistics.update(moving, stationary);
+		ewmaMatches = ewmaMatches && near(statistics.ewma(LD2410_MOVING, 0), ewmas[i]);
+		if(i == 0)
+		{
+			LD2410_CHECK(statistics.variance(LD2410_MOVING, 0) == 0);	//Needs two frames
+			LD2410_CHECK(statistics.mean(LD2410_MOVING, 0) == 2);
+		}
+	}
+	LD2410_CHECK(ewmaMatches);
+	LD2410_CHECK(statistics.samples() == sizeof(series));
+	bool allGates = true;
+	for(uint8_t gate = 0; gate < LD2410_GATES; gate++)
+	{
+		allGates = allGates && statistics.minimum(LD2410_MOVING, gate) == 2 + gate && statistics.maximum(LD2410_MOVING, gate) == 9 + gate;
+		allGates = allGates && near(statistics.mean(LD2410_MOVING, gate), 5 + gate);
+		allGates = allGates && near(statistics.variance(LD2410_MOVING, gate), 32.0f / 7);
+		allGates = allGates && near(statistics.ewma(LD2410_MOVING, gate), 7.421875f + gate);
+		allGates = allGates && statistics.minimum(LD2410_STATIONARY, gate) == 91 - gate && statistics.maximum(LD2410_STATIONARY, gate) == 98 - gate;
+		allGates = allGates && near(statistics.mean(LD2410_STATIONARY, gate), 95 - gate);
+		allGates = allGates && near(statistics.variance(LD2410_STATIONARY, gate), 32.0f / 7);
+		allGates = allGates && near(statistics.ewma(LD2410_STATIONARY, gate), 100 - 7.421875f - gate);
+	}
+	LD2410_CHECK(allGates);
+	statistics.reset();
+	LD2410_CHECK(statistics.samples() == 0);
+	LD2410_CHECK(statistics.minimum(LD2410_MOVING, 4) == 0 && statistics.maximum(LD2410_MOVING, 4) == 0);
+	LD2410_CHECK(statistics.mean(LD2410_STATIONARY, 4) == 0 && statistics.variance(LD2410_STATIONARY, 4) == 0 && statistics.ewma(LD2410_STATIONARY, 4) == 0);
+	fill(50, moving, stationary);
+	statistics.update(moving, stationary);
+	LD2410_CHECK(statistics.minimum(LD2410_MOVING, 0) == 50 && statistics.maximum(LD2410_MOVING, 0) == 50);	//Starts again from the first frame
+	LD2410_CHECK(statistics.ewma(LD2410_MOVING, 0) == 50);
+}
+
+static void constant()	//A steady energy has no variance
+{
+	ld2410GateStatistics statistics;
+	uint8_t moving[LD2410_GATES];
+	uint8_t stationary[LD2410_GATES];
+	fill(30, moving, stationary);
+	for(uint16_t i = 0; i < 1000; i++)
+	{
+		statistics.update(moving, stationary);
+	}
+	LD2410_CHECK(near(statistics.mean(LD2410_MOVING, 3), 33) && near(statistics.variance(LD2410_MOVING, 3), 0));
+	LD2410_CHECK(near(statistics.ewma(LD2410_STATIONARY, 3), 67));
+}
+
+static void addReading(const ld2410Reading &reading, void *context)
+{
+	static_cast<ld2410GateStatistics *>(context)->update(reading);
+}
+
+static void readings()	//From decoded frames, only engineering frames have gate energies
+{
+	ld2410TestSensor sensor;
+	ld2410 radar;
+	radar.begin(sensor, false);
+	ld2410GateStatistics statistics(0.5);
+	uint8_t moving[LD2410_GATES];
+	uint8_t stationary[LD2410_GATES];
+	for(uint8_t i = 0; i < sizeof(series); i++)
+	{
+		fill(series[i], moving, stationary);
+		sensor.sendEngineeringFrame(moving, stationary);
+		sensor.sendDataFrame(0x01, 100, 90, 0, 0);					//Ignored, no gate energies
+	}
+	radar.setDataCallback(addReading, &statistics);
+	radar.readAvailable();
+	LD2410_CHECK(statistics.samples() == sizeof(series));
+	LD2410_CHECK(near(statistics.mean(LD2410_MOVING, 8), 13) && near(statistics.variance(LD2410_MOVING, 8), 32.0f / 7));
+	LD2410_CHECK(near(statistics.ewma(LD2410_MOVING, 8), 15.421875f));
+	ld2410Reading reading = {};
+	reading.engineeringData = false;
+	reading.movingGateEnergy[0] = 100;
+	LD2410_CHECK(statistics.update(reading) == false);
+	reading.engineeringData = true;
+	LD2410_CHECK(statistics.update(reading));
+	LD2410_CHECK(statistics.samples() == sizeof(series) + 1 && statistics.maximum(LD2410_MOVING, 0) == 100);
+}
+
+int main()
+{
+	knownSeries();
+	constant();
+	readings();
+	return ld2410TestResult("gateStatisticsTest");
+}
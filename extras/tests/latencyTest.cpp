@@ -0,0 +1,80 @@
+/*
+ *	Round trip latencies and adaptive timeouts, checking timeouts are counted apart from the histogram and that restarting the
+ *	sensor doesn't wait for an ACK that never comes. From the root of the library...
+ *
+ *	g++ -std=gnu++11 -Isrc -Iextras/tests extras/tests/latencyTest.cpp src/ld2410*.cpp -o latencyTest -lpthread
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#include "ld2410Test.h"
+#if LD2410_LATENCY_HISTOGRAM == 0
+#error Build latencyTest with the latency histogram
+#endif
+
+static uint32_t roundTrips(ld2410 &radar, uint8_t kind)
+{
+	uint32_t total = 0;
+	for(uint8_t bucket = 0; bucket < LD2410_LATENCY_BUCKETS; bucket++)
+	{
+		total += radar.latencyHistogram(kind, bucket);
+	}
+	return total;
+}
+
+static void restartWithoutLeaveAck()	//Blocking and non-blocking, neither waits for the leave ACK
+{
+	ld2410TestSensor sensor;
+	ld2410 radar;
+	radar.begin(sensor, false);
+	uint32_t start = millis();
+	LD2410_CHECK(radar.requestRestart());
+	LD2410_CHECK(millis() - start < radar.commandTimeout(LD2410_LATENCY_LEAVE));
+	LD2410_CHECK(sensor.commands.back() == LD2410_CMD_LEAVE_CONFIGURATION);	//Still sent, in case the sensor didn't restart
+	LD2410_CHECK(radar.submitCommand(LD2410_CMD_RESTART));
+	while(radar.commandInProgress() && millis() - start < 1000)
+	{
+		radar.readAvailable();
+	}
+	LD2410_CHECK(radar.commandStatus() == LD2410_COMMAND_SUCCEEDED);
+	LD2410_CHECK(millis() - start < radar.commandTimeout(LD2410_LATENCY_LEAVE));
+	LD2410_CHECK(radar.requestFactoryReset());
+	LD2410_CHECK(millis() - start < radar.commandTimeout(LD2410_LATENCY_LEAVE));
+	LD2410_CHECK(radar.statistics().commandTimeouts == 0);
+	LD2410_CHECK(radar.latencyTimeouts(LD2410_LATENCY_LEAVE) == 0);
+	LD2410_CHECK(roundTrips(radar, LD2410_LATENCY_LEAVE) == 0);
+	LD2410_CHECK(radar.commandTimeout(LD2410_LATENCY_LEAVE) == 250);
+}
+
+static void timeoutsKeptApart()	//A lost ACK backs the timeout off, later ACKs adapt it from the histogram again
+{
+	ld2410TestSensor sensor;
+	ld2410 radar;
+	radar.begin(sensor, false);
+	sensor.loseAck = sensor.commands.size() + 1;						//After entering configuration mode
+	LD2410_CHECK(radar.setResolution(1) == false);
+	LD2410_CHECK(radar.statistics().commandTimeouts == 1);
+	LD2410_CHECK(radar.latencyTimeouts(LD2410_LATENCY_COMMAND) == 1);
+	LD2410_CHECK(roundTrips(radar, LD2410_LATENCY_COMMAND) == 0);
+	LD2410_CHECK(radar.commandTimeout(LD2410_LATENCY_COMMAND) == 500);
+	for(uint8_t i = 0; i < LD2410_LATENCY_MIN_SAMPLES; i++)
+	{
+		LD2410_CHECK(radar.setResolution(i & 1));
+	}
+	LD2410_CHECK(roundTrips(radar, LD2410_LATENCY_COMMAND) == LD2410_LATENCY_MIN_SAMPLES);
+	LD2410_CHECK(radar.latencyPercentile(LD2410_LATENCY_COMMAND, 99) < 10);
+	LD2410_CHECK(radar.commandTimeout(LD2410_LATENCY_COMMAND) == LD2410_MIN_COMMAND_TIMEOUT);
+	LD2410_CHECK(radar.latencyTimeouts(LD2410_LATENCY_COMMAND) == 1);
+	radar.resetLatency();
+	LD2410_CHECK(radar.latencyTimeouts(LD2410_LATENCY_COMMAND) == 0);
+	LD2410_CHECK(radar.commandTimeout(LD2410_LATENCY_COMMAND) == 250);
+}
+
+int main()
+{
+	restartWithoutLeaveAck();
+	timeoutsKeptApart();
+	return ld2410TestResult("latencyTest");
+}
@@ -0,0 +1,262 @@
+/*
+ *	Shared parts of the tests in extras/tests, which build natively on Linux with the library's Linux port.
+ *
+ *	ld2410TestSensor is a Stream that plays the part of an LD2410. It answers each command written to it with an ACK, as the
+ *	sensor would, keeps the configuration the commands change and sends data frames when asked. ACKs can be held back, lost or
+ *	made to fail, to test how the library copes.
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#ifndef ld2410Test_h
+#define ld2410Test_h
+#include <ld2410.h>
+#include <stdio.h>
+#include <deque>
+#include <vector>
+
+#define LD2410_CHECK(condition) ld2410TestCheck((condition), #condition, __FILE__, __LINE__)
+
+static int ld2410_test_failures_ = 0;
+
+static inline bool ld2410TestCheck(bool passed, const char *condition, const char *file, int line)	//Report a failed check and carry on
+{
+	if(passed == false)
+	{
+		fprintf(stderr, "%s:%d: check failed: %s\n", file, line, condition);
+		ld2410_test_failures_++;
+	}
+	return passed;
+}
+
+static inline int ld2410TestResult(const char *name)	//Exit status for main()
+{
+	if(ld2410_test_failures_ > 0)
+	{
+		printf("%s: %d checks FAILED\n", name, ld2410_test_failures_);
+		return 1;
+	}
+	printf("%s: passed\n", name);
+	return 0;
+}
+
+class ld2410TestSensor : public Stream	{
+
+	public:
+		ld2410TestSensor()												//Constructor function, starts with the factory settings
+		{
+			factoryReset();
+		}
+		int available() override
+		{
+			return to_library_.size();
+		}
+		int read() override
+		{
+			if(to_library_.empty())
+			{
+				return -1;
+			}
+			uint8_t byte_ = to_library_.front();
+			to_library_.pop_front();
+			return byte_;
+		}
+		int peek() override
+		{
+			return to_library_.empty() ? -1 : to_library_.front();
+		}
+		size_t write(uint8_t byte) override								//Commands are handled as soon as they are complete
+		{
+			from_library_.push_back(byte);
+			receive_();
+			return 1;
+		}
+		using Print::write;
+		void send(const uint8_t *data, size_t length)					//Queue raw bytes for the library to read
+		{
+			to_library_.insert(to_library_.end(), data, data + length);
+		}
+		void sendDataFrame(uint8_t targetType, uint16_t movingDistance, uint8_t movingEnergy, uint16_t stationaryDistance, uint8_t stationaryEnergy)
+		{
+			const uint8_t frame_[] = {0xF4, 0xF3, 0xF2, 0xF1, 0x0D, 0x00, 0x02, 0xAA, targetType, (uint8_t)stationaryDistance, (uint8_t)(stationaryDistance >> 8),
+				movingEnergy, 0x00, 0x00, stationaryEnergy, (uint8_t)movingDistance, (uint8_t)(movingDistance >> 8), 0x55, 0x00, 0xF8, 0xF7, 0xF6, 0xF5};
+			send(frame_, sizeof(frame_));
+		}
+		void sendEngineeringFrame(const uint8_t *moving, const uint8_t *stationary)	//LD2410_GATES energies of each type
+		{
+			std::vector<uint8_t> frame_ = {0xF4, 0xF3, 0xF2, 0xF1, 0x23, 0x00, 0x01, 0xAA, 0x03, 0x1E, 0x00, 0x3C, 0x00, 0x00, 0x39, 0x00, 0x00, 0x08, 0x08};
+			frame_.insert(frame_.end(), moving, moving + LD2410_GATES);
+			frame_.insert(frame_.end(), stationary, stationary + LD2410_GATES);
+			frame_.insert(frame_.end(), {0x03, 0x05, 0x55, 0x00, 0xF8, 0xF7, 0xF6, 0xF5});
+			send(frame_.data(), frame_.size());
+		}
+		void releaseAck()												//Send the oldest ACK held back
+		{
+			if(held_acks_.empty() == false)
+			{
+				send(held_acks_.front().data(), held_acks_.front().size());
+				held_acks_.pop_front();
+			}
+		}
+		void releaseAcks()
+		{
+			while(held_acks_.empty() == false)
+			{
+				releaseAck();
+			}
+		}
+		size_t heldAcks()
+		{
+			return held_acks_.size();
+		}
+		void factoryReset()
+		{
+			const uint8_t motion_[LD2410_GATES] = {50, 50, 40, 30, 20, 15, 15, 15, 15};
+			const uint8_t stationary_[LD2410_GATES] = {0, 0, 40, 40, 30, 30, 20, 20, 20};
+			memcpy(motionSensitivity, motion_, LD2410_GATES);
+			memcpy(stationarySensitivity, stationary_, LD2410_GATES);
+			maxMovingGate = 8;
+			maxStationaryGate = 8;
+			idleTime = 5;
+			resolution = 0;
+			bluetooth = true;
+		}
+		bool holdAcks = false;											//Keep ACKs back until releaseAck()
+		int loseAck = -1;												//Index in commands of a command whose ACK goes missing
+		uint8_t failCommand = 0;										//Opcode to reject
+		bool mute = false;												//Ignore everything
+		std::vector<uint8_t> commands;									//Opcodes received, in order
+		std::vector<std::vector<uint8_t> > frames;						//The complete frames received
+		bool configurationMode = false;
+		bool engineeringMode = false;
+		uint8_t maxMovingGate;
+		uint8_t maxStationaryGate;
+		uint16_t idleTime;
+		uint8_t motionSensitivity[LD2410_GATES];
+		uint8_t stationarySensitivity[LD2410_GATES];
+		uint8_t resolution;
+		bool bluetooth;
+	private:
+		std::deque<uint8_t> to_library_;
+		std::vector<uint8_t> from_library_;
+		std::deque<std::vector<uint8_t> > held_acks_;
+		void receive_()
+		{
+			while(from_library_.empty() == false && from_library_[0] != 0xFD)	//Resynchronise on the command header
+			{
+				from_library_.erase(from_library_.begin());
+			}
+			if(from_library_.size() < 6)
+			{
+				return;
+			}
+			size_t length_ = from_library_[4] + (from_library_[5] << 8) + 10;
+			if(from_library_.size() < length_)
+			{
+				return;
+			}
+			std::vector<uint8_t> frame_(from_library_.begin(), from_library_.begin() + length_);
+			from_library_.erase(from_library_.begin(), from_library_.begin() + length_);
+			frames.push_back(frame_);
+			commands.push_back(frame_[6]);
+			if(mute == false)
+			{
+				handle_(frame_, (int)commands.size() - 1);
+			}
+		}
+		uint16_t value_(const std::vector<uint8_t> &frame, uint8_t parameter)	//The value of a parameter word, for 0x60 and 0x64
+		{
+			return frame[10 + 6 * parameter] + (frame[11 + 6 * parameter] << 8);
+		}
+		void handle_(const std::vector<uint8_t> &frame, int index)
+		{
+			uint8_t command_ = frame[6];
+			if(command_ != LD2410_CMD_ENTER_CONFIGURATION && configurationMode == false)	//The real sensor ignores commands outside configuration mode
+			{
+				return;
+			}
+			bool success_ = command_ != failCommand;
+			std::vector<uint8_t> payload_;
+			if(success_)
+			{
+				switch(command_)
+				{
+					case LD2410_CMD_ENTER_CONFIGURATION:
+						configurationMode = true;
+						payload_ = {0x01, 0x00, 0x40, 0x00};
+						break;
+					case LD2410_CMD_LEAVE_CONFIGURATION:
+						configurationMode = false;
+						break;
+					case LD2410_CMD_SET_MAX_VALUES:
+						maxMovingGate = value_(frame, 0);
+						maxStationaryGate = value_(frame, 1);
+						idleTime = value_(frame, 2);
+						break;
+					case LD2410_CMD_SET_GATE_SENSITIVITY:
+						for(uint8_t gate = 0; gate < LD2410_GATES; gate++)
+						{
+							if(value_(frame, 0) == gate || value_(frame, 0) == 0xFFFF)
+							{
+								motionSensitivity[gate] = value_(frame, 1);
+								stationarySensitivity[gate] = value_(frame, 2);
+							}
+						}
+						break;
+					case LD2410_CMD_READ_CONFIGURATION:
+						payload_ = {0xAA, 0x08, maxMovingGate, maxStationaryGate};
+						payload_.insert(payload_.end(), motionSensitivity, motionSensitivity + LD2410_GATES);
+						payload_.insert(payload_.end(), stationarySensitivity, stationarySensitivity + LD2410_GATES);
+						payload_.insert(payload_.end(), {(uint8_t)idleTime, (uint8_t)(idleTime >> 8)});
+						break;
+					case LD2410_CMD_START_ENGINEERING_MODE:
+						engineeringMode = true;
+						break;
+					case LD2410_CMD_END_ENGINEERING_MODE:
+						engineeringMode = false;
+						break;
+					case LD2410_CMD_READ_FIRMWARE_VERSION:
+						payload_ = {0x00, 0x01, 0x02, 0x01, 0x16, 0x24, 0x06, 0x22};
+						break;
+					case LD2410_CMD_FACTORY_RESET:
+						factoryReset();
+						break;
+					case LD2410_CMD_RESTART:						//Comes back out of configuration mode, so leaving isn't ACKed
+						configurationMode = false;
+						engineeringMode = false;
+						break;
+					case LD2410_CMD_SET_BLUETOOTH:
+						bluetooth = frame[8] != 0;
+						break;
+					case LD2410_CMD_GET_MAC:
+						payload_ = {0x8F, 0x27, 0x2E, 0xB8, 0x0F, 0x65};
+						break;
+					case LD2410_CMD_SET_RESOLUTION:
+						resolution = frame[8];
+						break;
+					case LD2410_CMD_READ_RESOLUTION:
+						payload_ = {resolution, 0x00};
+						break;
+				}
+			}
+			if(index == loseAck)
+			{
+				return;
+			}
+			uint16_t length_ = 4 + payload_.size();
+			std::vector<uint8_t> ack_ = {0xFD, 0xFC, 0xFB, 0xFA, (uint8_t)length_, (uint8_t)(length_ >> 8), command_, 0x01, (uint8_t)(success_ ? 0x00 : 0x01), 0x00};
+			ack_.insert(ack_.end(), payload_.begin(), payload_.end());
+			ack_.insert(ack_.end(), {0x04, 0x03, 0x02, 0x01});
+			if(holdAcks)
+			{
+				held_acks_.push_back(ack_);
+			}
+			else
+			{
+				send(ack_.data(), ack_.size());
+			}
+		}
+};
+#endif
@@ -0,0 +1,117 @@
+/*
+ *	ld2410Manager servicing several scripted sensors, checking each poll() starts with a different sensor, drains no more than the
+ *	budget from each and keeps their health. From the root of the library...
+ *
+ *	g++ -std=gnu++11 -Isrc -Iextras/tests extras/tests/managerTest.cpp src/ld2410*.cpp -o managerTest -lpthread
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#include "ld2410Test.h"
+#include <ld2410Manager.h>
+
+#define MANAGER_TEST_SENSORS 3
+#define MANAGER_TEST_FRAME 23											//Bytes in a normal data frame
+
+static std::vector<uint16_t> order;										//Moving distance of each frame as it is decoded, across every sensor
+
+static void frameDecoded(const ld2410Reading &reading, void *)
+{
+	order.push_back(reading.movingTargetDistance);
+}
+
+static void rotation()	//Each sensor gets one frame per poll, the first sensor serviced moves on by one each time
+{
+	ld2410TestSensor sensors[MANAGER_TEST_SENSORS];
+	ld2410 radars[MANAGER_TEST_SENSORS];
+	ld2410Manager manager;
+	for(uint8_t i = 0; i < MANAGER_TEST_SENSORS; i++)
+	{
+		radars[i].begin(sensors[i], false);
+		radars[i].setDataCallback(frameDecoded);
+		LD2410_CHECK(manager.add(radars[i]));
+		for(uint8_t frame = 0; frame < MANAGER_TEST_SENSORS; frame++)
+		{
+			sensors[i].sendDataFrame(0x01, 100 * i + frame, 50, 0, 0);	//Sensor in the hundreds, frame in the units
+		}
+	}
+	LD2410_CHECK(manager.sensors() == MANAGER_TEST_SENSORS);
+	manager.setBudget(MANAGER_TEST_FRAME);
+	order.clear();
+	for(uint8_t poll = 0; poll < MANAGER_TEST_SENSORS; poll++)
+	{
+		LD2410_CHECK(manager.poll() == MANAGER_TEST_SENSORS);
+	}
+	const uint16_t expected[] = {0, 100, 200, 101, 201, 1, 202, 2, 102};
+	LD2410_CHECK(order.size() == sizeof(expected) / sizeof(expected[0]) && memcmp(order.data(), expected, sizeof(expected)) == 0);
+	LD2410_CHECK(manager.poll() == 0);
+}
+
+static void budget()	//A backlog is drained a budget at a time, and recorded
+{
+	ld2410TestSensor busy, quiet;
+	ld2410 busyRadar, quietRadar;
+	busyRadar.begin(busy, false);
+	quietRadar.begin(quiet, false);
+	ld2410Manager manager;
+	LD2410_CHECK(manager.add(busyRadar) && manager.add(quietRadar));
+	for(uint8_t frame = 0; frame < 6; frame++)
+	{
+		busy.sendDataFrame(0x01, 300 + frame, 50, 0, 0);
+	}
+	manager.setBudget(2 * MANAGER_TEST_FRAME);
+	LD2410_CHECK(manager.poll() == 2);
+	const ld2410SensorHealth &health = manager.health(0);
+	LD2410_CHECK(health.framesDecoded == 2);
+	LD2410_CHECK(health.bytesPending == 4 * MANAGER_TEST_FRAME && health.maxBytesPending == 4 * MANAGER_TEST_FRAME);
+	LD2410_CHECK(busy.available() == 4 * MANAGER_TEST_FRAME);		//No more than the budget was taken
+	LD2410_CHECK(health.connected);
+	LD2410_CHECK(manager.health(1).framesDecoded == 0 && manager.health(1).connected == false);
+	LD2410_CHECK(manager.poll() == 2 && manager.poll() == 2 && manager.poll() == 0);
+	LD2410_CHECK(health.framesDecoded == 6 && health.bytesPending == 0);
+	LD2410_CHECK(health.maxBytesPending == 4 * MANAGER_TEST_FRAME);	//The worst is kept
+	LD2410_CHECK(busyRadar.movingTargetDistance() == 305);
+	manager.setBudget(0);											//No limit
+	for(uint8_t frame = 0; frame < 6; frame++)
+	{
+		busy.sendDataFrame(0x01, 400 + frame, 50, 0, 0);
+	}
+	LD2410_CHECK(manager.poll() == 6 && health.bytesPending == 0);
+	delay(LD2410_MANAGER_TIMEOUT + 10);
+	manager.poll();
+	LD2410_CHECK(health.connected == false);						//Nothing for too long
+}
+
+static void outOfRange()	//Indexes past the last sensor added are refused rather than read past the end
+{
+	ld2410TestSensor sensor;
+	ld2410 radars[LD2410_MAX_SENSORS + 1];
+	ld2410Manager manager;
+	LD2410_CHECK(manager.sensor(0) == nullptr);
+	LD2410_CHECK(manager.health(0).framesDecoded == 0 && manager.health(0).connected == false);
+	LD2410_CHECK(manager.poll() == 0);
+	radars[0].begin(sensor, false);
+	sensor.sendDataFrame(0x01, 100, 50, 0, 0);
+	LD2410_CHECK(manager.add(radars[0]));
+	LD2410_CHECK(manager.poll() == 1);
+	LD2410_CHECK(manager.sensor(0) == &radars[0]);
+	LD2410_CHECK(manager.sensor(1) == nullptr && manager.sensor(255) == nullptr);
+	LD2410_CHECK(manager.health(1).framesDecoded == 0 && manager.health(255).lastFrame == 0);
+	for(uint8_t i = 1; i < LD2410_MAX_SENSORS; i++)
+	{
+		LD2410_CHECK(manager.add(radars[i]));
+	}
+	LD2410_CHECK(manager.add(radars[LD2410_MAX_SENSORS]) == false);	//Full
+	LD2410_CHECK(manager.sensors() == LD2410_MAX_SENSORS);
+	LD2410_CHECK(manager.sensor(LD2410_MAX_SENSORS) == nullptr);
+}
+
+int main()
+{
+	rotation();
+	budget();
+	outOfRange();
+	return ld2410TestResult("managerTest");
+}
@@ -0,0 +1,121 @@
+/*
+ *	Transactions with several commands in flight, checking ACKs are matched to commands in order and that a lost ACK only costs
+ *	the command it belonged to. Needs a pipeline deeper than one, from the root of the library...
+ *
+ *	g++ -std=gnu++11 -DLD2410_PIPELINE_DEPTH=3 -Isrc -Iextras/tests extras/tests/pipelineTest.cpp src/ld2410*.cpp -o pipelineTest -lpthread
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#include "ld2410Test.h"
+#if LD2410_PIPELINE_DEPTH != 3
+#error Build pipelineTest with -DLD2410_PIPELINE_DEPTH=3
+#endif
+
+static void queueFourCommands(ld2410 &radar)	//Different opcodes, so each ACK can only belong to one command
+{
+	LD2410_CHECK(radar.beginTransaction());
+	LD2410_CHECK(radar.queueMaxValues(6, 6, 10));
+	LD2410_CHECK(radar.queueResolution(1));
+	LD2410_CHECK(radar.queueBluetooth(false));
+	LD2410_CHECK(radar.queueGateSensitivityThreshold(3, 60, 50));
+}
+
+static void inOrder()	//ACKs held back and released one at a time
+{
+	ld2410TestSensor sensor;
+	ld2410 radar;
+	radar.begin(sensor, false);
+	sensor.holdAcks = true;
+	queueFourCommands(radar);
+	LD2410_CHECK(radar.commitTransaction(false));
+	LD2410_CHECK(sensor.commands.size() == 1);						//Only enter configuration mode until it is ACKed
+	sensor.releaseAck();
+	radar.readAvailable();
+	LD2410_CHECK(sensor.commands.size() == 4);						//Then as many as the pipeline holds
+	LD2410_CHECK(sensor.heldAcks() == 3);
+	LD2410_CHECK(radar.transactionResult(0) == LD2410_COMMAND_PENDING);
+	sensor.releaseAck();
+	radar.readAvailable();
+	LD2410_CHECK(radar.transactionResult(0) == LD2410_COMMAND_SUCCEEDED);
+	LD2410_CHECK(radar.transactionResult(1) == LD2410_COMMAND_PENDING);
+	LD2410_CHECK(sensor.commands.size() == 5);						//Each ACK makes room for one more
+	LD2410_CHECK(sensor.commands[4] == LD2410_CMD_SET_GATE_SENSITIVITY);
+	while(radar.commandInProgress())
+	{
+		sensor.releaseAcks();
+		radar.readAvailable();
+	}
+	LD2410_CHECK(radar.commandStatus() == LD2410_COMMAND_SUCCEEDED);
+	for(uint8_t i = 0; i < 4; i++)
+	{
+		LD2410_CHECK(radar.transactionResult(i) == LD2410_COMMAND_SUCCEEDED);
+	}
+	LD2410_CHECK(sensor.commands.back() == LD2410_CMD_LEAVE_CONFIGURATION);
+	LD2410_CHECK(sensor.maxMovingGate == 6 && sensor.idleTime == 10 && sensor.resolution == 1 && sensor.bluetooth == false);
+	LD2410_CHECK(sensor.motionSensitivity[3] == 60 && sensor.stationarySensitivity[3] == 50);
+	LD2410_CHECK(radar.max_moving_gate == 6 && radar.motion_sensitivity[3] == 60);	//Known without reading it back
+	LD2410_CHECK(radar.statistics().commandTimeouts == 0);
+}
+
+static void lostInTheMiddle()	//The ACK for the second command never comes, the one for the third shows it was lost
+{
+	ld2410TestSensor sensor;
+	ld2410 radar;
+	radar.begin(sensor, false);
+	sensor.loseAck = 2;												//Enter configuration mode is command 0
+	queueFourCommands(radar);
+	uint32_t start = millis();
+	LD2410_CHECK(radar.commitTransaction(false));
+	while(sensor.available() > 0)									//Each ACK read may send more commands
+	{
+		radar.readAvailable();
+	}
+	LD2410_CHECK(radar.commandInProgress() == false);				//No waiting for a timeout
+	LD2410_CHECK(millis() - start < radar.commandTimeout(LD2410_LATENCY_COMMAND));
+	LD2410_CHECK(radar.transactionResult(0) == LD2410_COMMAND_SUCCEEDED);
+	LD2410_CHECK(radar.transactionResult(1) == LD2410_COMMAND_TIMED_OUT);
+	LD2410_CHECK(radar.transactionResult(2) == LD2410_COMMAND_SUCCEEDED);
+	LD2410_CHECK(radar.transactionResult(3) == LD2410_COMMAND_SUCCEEDED);
+	LD2410_CHECK(radar.commandStatus() == LD2410_COMMAND_TIMED_OUT);
+	LD2410_CHECK(radar.statistics().commandTimeouts == 1);
+	LD2410_CHECK(sensor.resolution == 1);							//It was applied, only the ACK went missing
+}
+
+static void lostAtTheEnd()	//Nothing comes after the lost ACK, so it has to time out
+{
+	ld2410TestSensor sensor;
+	ld2410 radar;
+	radar.begin(sensor, false);
+	sensor.loseAck = 4;
+	queueFourCommands(radar);
+	uint16_t timeout = radar.commandTimeout(LD2410_LATENCY_COMMAND);
+	uint32_t start = millis();
+	LD2410_CHECK(radar.commitTransaction(false));
+	while(radar.commandInProgress() && millis() - start < 2000)
+	{
+		radar.readAvailable();
+	}
+	LD2410_CHECK(radar.commandInProgress() == false);
+	LD2410_CHECK(millis() - start >= timeout);
+	#if LD2410_LATENCY_HISTOGRAM
+	LD2410_CHECK(radar.commandTimeout(LD2410_LATENCY_COMMAND) == 2 * timeout);	//Backed off, the timeout isn't a round trip
+	#endif
+	for(uint8_t i = 0; i < 3; i++)
+	{
+		LD2410_CHECK(radar.transactionResult(i) == LD2410_COMMAND_SUCCEEDED);
+	}
+	LD2410_CHECK(radar.transactionResult(3) == LD2410_COMMAND_TIMED_OUT);
+	LD2410_CHECK(radar.statistics().commandTimeouts == 1);
+	LD2410_CHECK(sensor.commands.back() == LD2410_CMD_LEAVE_CONFIGURATION);
+}
+
+int main()
+{
+	inOrder();
+	lostInTheMiddle();
+	lostAtTheEnd();
+	return ld2410TestResult("pipelineTest");
+}
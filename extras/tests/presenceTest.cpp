@@ -0,0 +1,191 @@
+/*
+ *	ld2410Presence fed readings with the time supplied, checking the hysteresis, dwell times and smoothing and that the callback
+ *	is called once for each enter and leave. From the root of the library...
+ *
+ *	g++ -std=gnu++11 -Isrc -Iextras/tests extras/tests/presenceTest.cpp src/ld2410*.cpp -o presenceTest -lpthread
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#include "ld2410Test.h"
+#include <ld2410Presence.h>
+
+#define PRESENCE_TEST_FRAME 100											//Time between frames in ms, the sensor's rate is about ten a second
+
+struct presenceTestEvents {
+	uint32_t enters = 0;
+	uint32_t leaves = 0;
+	bool last = false;
+};
+
+static void presenceChanged(bool present, const ld2410Reading &, void *context)
+{
+	presenceTestEvents *events = static_cast<presenceTestEvents *>(context);
+	if(present)
+	{
+		events->enters++;
+	}
+	else
+	{
+		events->leaves++;
+	}
+	events->last = present;
+}
+
+static ld2410Reading stationary(uint8_t energy, uint16_t distance)
+{
+	ld2410Reading reading = {};
+	reading.targetType = energy > 0 ? 0x02 : 0x00;
+	reading.stationaryTargetEnergy = energy;
+	reading.stationaryTargetDistance = distance;
+	return reading;
+}
+
+static uint32_t feedFor(ld2410Presence &presence, const ld2410Reading &reading, uint32_t &now, uint32_t duration)	//Frames for duration ms, returns how many reported a change
+{
+	uint32_t changed = 0;
+	for(uint32_t end = now + duration; now < end; now += PRESENCE_TEST_FRAME)
+	{
+		changed += presence.update(reading, now);
+	}
+	return changed;
+}
+
+static void setUp(ld2410Presence &presence, presenceTestEvents &events)	//Smoothing off, so only the thresholds and dwell times matter
+{
+	presence.setEnergyThresholds(40, 20);
+	presence.setDistanceThresholds(600, 700);
+	presence.setDwellTimes(500, 2000);
+	presence.setSmoothing(0);
+	presence.setCallback(presenceChanged, &events);
+}
+
+static void enterAndLeaveAfterDwell()
+{
+	ld2410Presence presence;
+	presenceTestEvents events;
+	setUp(presence, events);
+	uint32_t now = 1000;
+	LD2410_CHECK(feedFor(presence, stationary(50, 300), now, 500) == 0);	//Frames at 0, 100...400ms into the dwell
+	LD2410_CHECK(presence.present() == false && events.enters == 0);
+	LD2410_CHECK(presence.update(stationary(50, 300), now));		//500ms after the first
+	LD2410_CHECK(presence.present() && events.enters == 1 && events.last);
+	now += PRESENCE_TEST_FRAME;
+	LD2410_CHECK(feedFor(presence, stationary(50, 300), now, 10000) == 0);	//Staying present isn't reported again
+	LD2410_CHECK(events.enters == 1 && events.leaves == 0);
+	LD2410_CHECK(feedFor(presence, stationary(0, 0), now, 2000) == 0);
+	LD2410_CHECK(presence.present());
+	LD2410_CHECK(presence.update(stationary(0, 0), now));
+	LD2410_CHECK(presence.present() == false && events.leaves == 1 && events.last == false);
+	now += PRESENCE_TEST_FRAME;
+	LD2410_CHECK(feedFor(presence, stationary(0, 0), now, 10000) == 0);
+	LD2410_CHECK(events.enters == 1 && events.leaves == 1);
+	LD2410_CHECK(presence.changes() == 2);
+	presence.reset();
+	LD2410_CHECK(presence.changes() == 0 && presence.present() == false && presence.energy() == 0);
+}
+
+static void hysteresis()	//Between the enter and exit thresholds nothing changes, whichever state it is in
+{
+	ld2410Presence presence;
+	presenceTestEvents events;
+	setUp(presence, events);
+	uint32_t now = 0;
+	LD2410_CHECK(feedFor(presence, stationary(30, 300), now, 10000) == 0);	//Too weak to enter
+	LD2410_CHECK(feedFor(presence, stationary(50, 650), now, 10000) == 0);	//Too far to enter
+	LD2410_CHECK(presence.present() == false);
+	LD2410_CHECK(feedFor(presence, stationary(50, 300), now, 1000) == 1);
+	LD2410_CHECK(feedFor(presence, stationary(30, 300), now, 10000) == 0);	//Strong enough to stay
+	LD2410_CHECK(feedFor(presence, stationary(50, 650), now, 10000) == 0);	//Near enough to stay
+	LD2410_CHECK(presence.present());
+	LD2410_CHECK(feedFor(presence, stationary(15, 300), now, 3000) == 1);	//Below the exit energy
+	LD2410_CHECK(feedFor(presence, stationary(50, 300), now, 1000) == 1);
+	LD2410_CHECK(feedFor(presence, stationary(50, 750), now, 3000) == 1);	//Beyond the exit distance
+	LD2410_CHECK(events.enters == 2 && events.leaves == 2);
+}
+
+static void interruptedDwell()	//One frame the other way starts the dwell time again
+{
+	ld2410Presence presence;
+	presenceTestEvents events;
+	setUp(presence, events);
+	uint32_t now = 0;
+	for(uint8_t i = 0; i < 10; i++)
+	{
+		LD2410_CHECK(feedFor(presence, stationary(50, 300), now, 400) == 0);
+		LD2410_CHECK(feedFor(presence, stationary(0, 0), now, PRESENCE_TEST_FRAME) == 0);
+	}
+	LD2410_CHECK(presence.present() == false && events.enters == 0);
+	LD2410_CHECK(feedFor(presence, stationary(50, 300), now, 1000) == 1);
+	for(uint8_t i = 0; i < 10; i++)
+	{
+		LD2410_CHECK(feedFor(presence, stationary(0, 0), now, 1900) == 0);
+		LD2410_CHECK(feedFor(presence, stationary(50, 300), now, PRESENCE_TEST_FRAME) == 0);
+	}
+	LD2410_CHECK(presence.present() && events.enters == 1 && events.leaves == 0);
+}
+
+static void smoothing()
+{
+	ld2410Presence presence;
+	presenceTestEvents events;
+	setUp(presence, events);
+	presence.update(stationary(80, 300), 0);						//Off, each frame's energy is taken as it is
+	LD2410_CHECK(presence.energy() == 80);
+	presence.update(stationary(10, 300), 100);
+	LD2410_CHECK(presence.energy() == 10);
+	presence.reset();
+	presence.setSmoothing(3);										//An eighth of the way each frame
+	presence.update(stationary(80, 300), 0);
+	LD2410_CHECK(presence.energy() == 10);
+	presence.update(stationary(80, 300), 100);
+	LD2410_CHECK(presence.energy() == 19);
+	uint32_t now = 200;
+	feedFor(presence, stationary(80, 300), now, 10000);
+	LD2410_CHECK(presence.energy() == 80);							//Rounded up on the way, so it gets there
+	presence.reset();
+	presence.setDwellTimes(0, 0);
+	LD2410_CHECK(presence.update(stationary(80, 300), 0) == false);	//A single strong frame is smoothed below the enter energy
+	LD2410_CHECK(presence.update(stationary(80, 300), 100) == false);
+	LD2410_CHECK(presence.update(stationary(80, 300), 200) == false);
+	LD2410_CHECK(presence.update(stationary(80, 300), 300) == false);
+	LD2410_CHECK(presence.update(stationary(80, 300), 400) == false);
+	LD2410_CHECK(presence.energy() == 39);
+	LD2410_CHECK(presence.update(stationary(80, 300), 500) == true);	//10, 19, 26, 33, 39 then 44, past the enter energy
+	LD2410_CHECK(presence.energy() == 44);
+	presence.setSmoothing(200);										//Clamped to 1/128, one empty frame barely moves it
+	LD2410_CHECK(presence.update(stationary(0, 300), 600) == false);
+	LD2410_CHECK(presence.energy() == 44 && presence.present());
+}
+
+static void strongestTarget()	//The stronger of the moving and stationary targets is used, frames without one keep the distance
+{
+	ld2410Presence presence;
+	presenceTestEvents events;
+	setUp(presence, events);
+	ld2410Reading reading = {};
+	reading.targetType = 0x03;
+	reading.movingTargetEnergy = 70;
+	reading.movingTargetDistance = 250;
+	reading.stationaryTargetEnergy = 45;
+	reading.stationaryTargetDistance = 650;
+	presence.update(reading, 0);
+	LD2410_CHECK(presence.energy() == 70 && presence.distance() == 250);
+	reading.stationaryTargetEnergy = 90;
+	presence.update(reading, 100);
+	LD2410_CHECK(presence.energy() == 90 && presence.distance() == 650);
+	presence.update(stationary(0, 0), 200);
+	LD2410_CHECK(presence.energy() == 0 && presence.distance() == 650);
+}
+
+int main()
+{
+	enterAndLeaveAfterDwell();
+	hysteresis();
+	interruptedDwell();
+	smoothing();
+	strongestTarget();
+	return ld2410TestResult("presenceTest");
+}
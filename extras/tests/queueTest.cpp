@@ -0,0 +1,98 @@
+/*
+ *	The lock-free single-producer/single-consumer queue used by ld2410Task, filled and emptied from two threads at once. From the
+ *	root of the library...
+ *
+ *	g++ -std=gnu++11 -O2 -Isrc -Iextras/tests extras/tests/queueTest.cpp src/ld2410*.cpp -o queueTest -lpthread
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#include "ld2410Test.h"
+#include <ld2410Queue.h>
+#include <thread>
+
+#define QUEUE_TEST_ITEMS 200000UL
+
+struct queueTestItem {													//Big enough that a torn copy would show
+	uint32_t sequence;
+	uint32_t check;
+	uint8_t padding[24];
+};
+
+static void singleThread()	//Fill, overflow and wrap the indexes
+{
+	ld2410Queue<uint32_t, 4> queue;
+	uint32_t item = 0;
+	LD2410_CHECK(queue.pop(item) == false);
+	for(uint32_t i = 0; i < 4; i++)
+	{
+		LD2410_CHECK(queue.push(i));
+	}
+	LD2410_CHECK(queue.size() == 4);
+	LD2410_CHECK(queue.push(99) == false);							//Full, the new item is dropped
+	LD2410_CHECK(queue.overflows() == 1);
+	for(uint32_t i = 0; i < 4; i++)
+	{
+		LD2410_CHECK(queue.pop(item) && item == i);
+	}
+	LD2410_CHECK(queue.size() == 0);
+	for(uint32_t i = 0; i < 1000; i++)								//Round and round the buffer
+	{
+		LD2410_CHECK(queue.push(i) && queue.push(i + 1));
+		LD2410_CHECK(queue.pop(item) && item == i);
+		LD2410_CHECK(queue.pop(item) && item == i + 1);
+	}
+	LD2410_CHECK(queue.overflows() == 1);
+}
+
+static void twoThreads()	//Every item arrives once, in order and intact, with the producer retrying when it is full
+{
+	static ld2410Queue<queueTestItem, 16> queue;
+	uint32_t retries = 0;
+	std::thread producer([&retries]()
+	{
+		queueTestItem item = {};
+		for(uint32_t i = 0; i < QUEUE_TEST_ITEMS; i++)
+		{
+			item.sequence = i;
+			item.check = (uint32_t)(i * 2654435761UL);
+			memset(item.padding, (uint8_t)i, sizeof(item.padding));
+			while(queue.push(item) == false)
+			{
+				retries++;
+				std::this_thread::yield();							//Let the consumer run, even on one core
+			}
+		}
+	});
+	uint32_t expected = 0;
+	bool intact = true;
+	queueTestItem item;
+	while(expected < QUEUE_TEST_ITEMS)
+	{
+		if(queue.pop(item))
+		{
+			if(item.sequence != expected || item.check != (uint32_t)(expected * 2654435761UL) || item.padding[0] != (uint8_t)expected || item.padding[23] != (uint8_t)expected)
+			{
+				intact = false;
+			}
+			expected++;
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+	producer.join();
+	LD2410_CHECK(intact);
+	LD2410_CHECK(queue.size() == 0);
+	LD2410_CHECK(queue.overflows() == retries);						//Every failed push counted, none lost
+}
+
+int main()
+{
+	singleThread();
+	twoThreads();
+	return ld2410TestResult("queueTest");
+}
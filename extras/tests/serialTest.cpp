@@ -0,0 +1,209 @@
+/*
+ *	ld2410Serial on the slave end of a pseudo-terminal, with ld2410TestSensor playing the sensor on the master end. Checks the
+ *	tty is left raw, reads never wait and a command makes the round trip through the kernel. From the root of the library...
+ *
+ *	g++ -std=gnu++11 -Isrc -Iextras/tests extras/tests/serialTest.cpp src/ld2410*.cpp -o serialTest -lpthread -lutil
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#include "ld2410Test.h"
+#include <ld2410Serial.h>
+#include <pty.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <termios.h>
+#include <string>
+
+class serialTestPty	{												//A pseudo-terminal pair, ld2410Serial opens the slave by name
+
+	public:
+		serialTestPty()
+		{
+			char name_[64];
+			if(openpty(&master, &slave_, name_, nullptr, nullptr) == 0)
+			{
+				fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+				name = name_;
+			}
+		}
+		~serialTestPty()
+		{
+			if(master >= 0)
+			{
+				close(master);
+				close(slave_);
+			}
+		}
+		std::vector<uint8_t> receive(int timeout)						//Whatever ld2410Serial has written, waiting up to timeout ms for the first byte
+		{
+			std::vector<uint8_t> bytes_;
+			struct pollfd poll_fd_ = {master, POLLIN, 0};
+			while(poll(&poll_fd_, 1, bytes_.empty() ? timeout : 0) > 0)
+			{
+				uint8_t buffer_[64];
+				ssize_t length_ = ::read(master, buffer_, sizeof(buffer_));
+				if(length_ <= 0)
+				{
+					break;
+				}
+				bytes_.insert(bytes_.end(), buffer_, buffer_ + length_);
+			}
+			return bytes_;
+		}
+		void pump(ld2410TestSensor &sensor, int timeout)				//Pass commands to the sensor and whatever it sends back to ld2410Serial
+		{
+			std::vector<uint8_t> commands_ = receive(timeout);
+			sensor.write(commands_.data(), commands_.size());
+			std::vector<uint8_t> replies_;
+			while(sensor.available() > 0)
+			{
+				replies_.push_back(sensor.read());
+			}
+			if(replies_.size() > 0)
+			{
+				LD2410_CHECK(::write(master, replies_.data(), replies_.size()) == (ssize_t)replies_.size());
+			}
+		}
+		int master = -1;
+		std::string name;
+	private:
+		int slave_ = -1;												//Held open so the pair outlives ld2410Serial closing its end
+};
+
+static void rawMode()	//Line discipline off, every byte passed through as it is and nothing echoed
+{
+	serialTestPty pty;
+	LD2410_CHECK(pty.master >= 0);
+	ld2410Serial serial;
+	LD2410_CHECK(serial.begin(pty.name.c_str()));
+	struct termios settings;
+	LD2410_CHECK(tcgetattr(serial.fd(), &settings) == 0);
+	LD2410_CHECK((settings.c_lflag & (ICANON | ECHO | ISIG | IEXTEN)) == 0);
+	LD2410_CHECK((settings.c_iflag & (ICRNL | INLCR | IGNCR | IXON | ISTRIP)) == 0);
+	LD2410_CHECK((settings.c_oflag & OPOST) == 0);
+	LD2410_CHECK((settings.c_cflag & CSIZE) == CS8);
+	const uint8_t awkward[] = {0xFD, 0x0D, 0x0A, 0x03, 0x11, 0x13, 0x7F, 0x04, 0x00, 0xFF};	//CR, LF, ^C, XON, XOFF, DEL, ^D
+	LD2410_CHECK(::write(pty.master, awkward, sizeof(awkward)) == sizeof(awkward));
+	LD2410_CHECK(serial.wait(1000));								//No newline needed, canonical mode would hold these back
+	std::vector<uint8_t> received;
+	uint32_t started = millis();
+	while(received.size() < sizeof(awkward) && millis() - started < 1000)
+	{
+		int byte = serial.read();
+		if(byte >= 0)
+		{
+			received.push_back(byte);
+		}
+		else
+		{
+			serial.wait(10);
+		}
+	}
+	LD2410_CHECK(received.size() == sizeof(awkward) && memcmp(received.data(), awkward, sizeof(awkward)) == 0);
+	LD2410_CHECK(pty.receive(20).empty());							//Not echoed back to the sensor
+	LD2410_CHECK(serial.write(awkward, sizeof(awkward)) == sizeof(awkward));
+	std::vector<uint8_t> written = pty.receive(1000);				//And not translated on the way out
+	LD2410_CHECK(written.size() == sizeof(awkward) && memcmp(written.data(), awkward, sizeof(awkward)) == 0);
+}
+
+static void nonBlocking()	//Nothing waiting, reads return at once
+{
+	serialTestPty pty;
+	ld2410Serial serial;
+	LD2410_CHECK(serial.begin(pty.name.c_str()));
+	uint32_t started = millis();
+	LD2410_CHECK(serial.available() == 0);
+	LD2410_CHECK(serial.read() == -1);
+	LD2410_CHECK(serial.peek() == -1);
+	LD2410_CHECK(millis() - started < 50);
+	LD2410_CHECK(serial.wait(0) == false);
+	started = millis();
+	LD2410_CHECK(serial.wait(30) == false);							//Waits as long as asked and no longer
+	LD2410_CHECK(millis() - started >= 25 && millis() - started < 500);
+	ld2410 radar;
+	radar.begin(serial, false);
+	started = millis();
+	for(uint8_t i = 0; i < 100; i++)
+	{
+		LD2410_CHECK(radar.readAvailable() == false);
+	}
+	LD2410_CHECK(millis() - started < 50);
+	serial.end();
+	LD2410_CHECK(serial.fd() == -1 && serial.read() == -1 && serial.wait(0) == false);
+}
+
+static void availableCounts()	//Bytes still in the kernel and bytes already buffered are both counted
+{
+	serialTestPty pty;
+	ld2410Serial serial;
+	LD2410_CHECK(serial.begin(pty.name.c_str()));
+	const uint8_t bytes[] = {1, 2, 3, 4, 5, 6, 7, 8};
+	LD2410_CHECK(::write(pty.master, bytes, 5) == 5);
+	LD2410_CHECK(serial.wait(1000));
+	LD2410_CHECK(serial.available() == 5);
+	LD2410_CHECK(serial.peek() == 1);								//Pulls them into the buffer
+	LD2410_CHECK(serial.available() == 5);
+	LD2410_CHECK(serial.read() == 1 && serial.read() == 2);
+	LD2410_CHECK(serial.available() == 3);
+	LD2410_CHECK(::write(pty.master, &bytes[5], 3) == 3);
+	uint32_t started = millis();
+	while(serial.available() < 6 && millis() - started < 1000)
+	{
+		delay(1);
+	}
+	LD2410_CHECK(serial.available() == 6);
+	bool inOrder = true;
+	for(uint8_t i = 2; i < sizeof(bytes); i++)
+	{
+		inOrder = inOrder && serial.read() == bytes[i];
+	}
+	LD2410_CHECK(inOrder);
+	LD2410_CHECK(serial.available() == 0);
+}
+
+static void commandRoundTrip()	//A non-blocking command and a data frame through the pseudo-terminal
+{
+	serialTestPty pty;
+	ld2410Serial serial;
+	LD2410_CHECK(serial.begin(pty.name.c_str()));
+	ld2410TestSensor sensor;
+	ld2410 radar;
+	radar.begin(serial, false);
+	LD2410_CHECK(radar.submitCommand(LD2410_CMD_SET_RESOLUTION, 1));
+	uint32_t started = millis();
+	while(radar.commandInProgress() && millis() - started < 2000)
+	{
+		pty.pump(sensor, 10);
+		serial.wait(10);
+		radar.readAvailable();
+	}
+	LD2410_CHECK(radar.commandInProgress() == false);
+	LD2410_CHECK(radar.commandStatus() == LD2410_COMMAND_SUCCEEDED);
+	LD2410_CHECK(sensor.resolution == 1);
+	const uint8_t expected[] = {LD2410_CMD_ENTER_CONFIGURATION, LD2410_CMD_SET_RESOLUTION, LD2410_CMD_LEAVE_CONFIGURATION};
+	LD2410_CHECK(sensor.commands.size() == sizeof(expected) && memcmp(sensor.commands.data(), expected, sizeof(expected)) == 0);
+	sensor.sendDataFrame(0x01, 123, 45, 0, 0);
+	pty.pump(sensor, 0);
+	LD2410_CHECK(serial.wait(1000));
+	started = millis();
+	while(radar.statistics().dataFrames == 0 && millis() - started < 1000)
+	{
+		serial.wait(10);
+		radar.readAvailable();
+	}
+	LD2410_CHECK(radar.statistics().dataFrames == 1);
+	LD2410_CHECK(radar.movingTargetDetected() && radar.movingTargetDistance() == 123);
+}
+
+int main()
+{
+	rawMode();
+	nonBlocking();
+	availableCounts();
+	commandRoundTrip();
+	return ld2410TestResult("serialTest");
+}
@@ -0,0 +1,125 @@
+/*
+ *	The configuration cache kept in an ld2410FileStorage, checking it round trips, is only written when something changed and
+ *	seeds a new ld2410 so settings it already holds aren't sent. From the root of the library...
+ *
+ *	g++ -std=gnu++11 -Isrc -Iextras/tests extras/tests/storageTest.cpp src/ld2410*.cpp -o storageTest -lpthread
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#include "ld2410Test.h"
+#include <ld2410FileStorage.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+class countingStorage : public ld2410FileStorage	{						//Counts the writes that would wear out flash or EEPROM
+
+	public:
+		countingStorage(const char *directory) : ld2410FileStorage(directory) {}
+		bool save(const char *key, const uint8_t *data, uint16_t length) override
+		{
+			saves++;
+			return ld2410FileStorage::save(key, data, length);
+		}
+		uint32_t saves = 0;
+};
+
+static void roundTrip(const char *directory)
+{
+	ld2410FileStorage storage(directory);
+	const uint8_t saved[] = {1, 2, 3, 4, 5};
+	uint8_t loaded[sizeof(saved)] = {};
+	LD2410_CHECK(storage.load("roundTrip", loaded, sizeof(loaded)) == false);	//Nothing saved yet
+	LD2410_CHECK(storage.save("roundTrip", saved, sizeof(saved)));
+	LD2410_CHECK(storage.load("roundTrip", loaded, sizeof(loaded)));
+	LD2410_CHECK(memcmp(saved, loaded, sizeof(saved)) == 0);
+	LD2410_CHECK(storage.load("roundTrip", loaded, sizeof(loaded) - 1) == false);	//Exactly the length saved
+	const uint8_t replaced[] = {9, 8, 7, 6, 5};
+	LD2410_CHECK(storage.save("roundTrip", replaced, sizeof(replaced)));
+	LD2410_CHECK(storage.load("roundTrip", loaded, sizeof(loaded)) && memcmp(replaced, loaded, sizeof(replaced)) == 0);
+	ld2410FileStorage missing("/nonexistent/ld2410");
+	LD2410_CHECK(missing.save("roundTrip", saved, sizeof(saved)) == false);
+}
+
+static void writesSkipped(const char *directory)	//Reading back or setting what is already known writes nothing
+{
+	ld2410TestSensor sensor;
+	ld2410 radar;
+	countingStorage storage(directory);
+	radar.begin(sensor, false);
+	LD2410_CHECK(radar.setStorage(&storage, "skipped") == false);
+	LD2410_CHECK(radar.requestCurrentConfiguration());
+	LD2410_CHECK(storage.saves == 1);
+	LD2410_CHECK(radar.requestCurrentConfiguration());				//Provisioning reads the same values on every boot
+	LD2410_CHECK(radar.requestResolution());
+	LD2410_CHECK(storage.saves == 2);
+	LD2410_CHECK(radar.requestResolution());
+	LD2410_CHECK(storage.saves == 2);
+	size_t sent = sensor.commands.size();
+	LD2410_CHECK(radar.setMaxValues(sensor.maxMovingGate, sensor.maxStationaryGate, sensor.idleTime));
+	LD2410_CHECK(sensor.commands.size() == sent);					//Not even sent
+	LD2410_CHECK(storage.saves == 2);
+	LD2410_CHECK(radar.setMaxValues(6, 6, 10));
+	LD2410_CHECK(storage.saves == 3);
+	sensor.idleTime = 20;											//Changed elsewhere, eg. over Bluetooth
+	LD2410_CHECK(radar.requestCurrentConfiguration());
+	LD2410_CHECK(storage.saves == 4);
+}
+
+static void seeded(const char *directory)	//A new ld2410 starts from the saved configuration
+{
+	ld2410TestSensor sensor;
+	{
+		ld2410 radar;
+		ld2410FileStorage storage(directory);
+		radar.begin(sensor, false);
+		radar.setStorage(&storage, "seeded");
+		LD2410_CHECK(radar.requestCurrentConfiguration());
+		LD2410_CHECK(radar.setGateSensitivityThreshold(4, 35, 25));
+		LD2410_CHECK(radar.setResolution(1));
+		LD2410_CHECK(radar.disableBluetooth());
+	}
+	sensor.commands.clear();
+	ld2410 radar;
+	countingStorage storage(directory);
+	radar.begin(sensor, false);
+	LD2410_CHECK(radar.setStorage(&storage, "seeded"));
+	LD2410_CHECK(radar.max_moving_gate == sensor.maxMovingGate && radar.sensor_idle_time == sensor.idleTime);
+	LD2410_CHECK(radar.motion_sensitivity[4] == 35 && radar.stationary_sensitivity[4] == 25);
+	LD2410_CHECK(radar.resolution == 1);
+	LD2410_CHECK(radar.infoAvailable(LD2410_INFO_CONFIGURATION | LD2410_INFO_RESOLUTION));	//Known without asking
+	LD2410_CHECK(radar.beginTransaction());
+	LD2410_CHECK(radar.queueGateSensitivityThreshold(4, 35, 25));
+	LD2410_CHECK(radar.queueResolution(1));
+	LD2410_CHECK(radar.queueBluetooth(false));
+	LD2410_CHECK(radar.commitTransaction());
+	LD2410_CHECK(sensor.commands.empty());							//Nothing the sensor doesn't already have
+	LD2410_CHECK(storage.saves == 0);
+	LD2410_CHECK(radar.setGateSensitivityThreshold(4, 40, 25));
+	LD2410_CHECK(sensor.motionSensitivity[4] == 40);
+	LD2410_CHECK(storage.saves == 1);
+}
+
+int main()
+{
+	char directory[] = "/tmp/ld2410StorageXXXXXX";
+	if(mkdtemp(directory) == nullptr)
+	{
+		perror("mkdtemp");
+		return 1;
+	}
+	roundTrip(directory);
+	writesSkipped(directory);
+	seeded(directory);
+	const char *keys[] = {"roundTrip", "skipped", "seeded"};
+	for(const char *key : keys)
+	{
+		char path[LD2410_STORAGE_PATH_LENGTH];
+		snprintf(path, sizeof(path), "%s/%s", directory, key);
+		unlink(path);
+	}
+	rmdir(directory);
+	return ld2410TestResult("storageTest");
+}
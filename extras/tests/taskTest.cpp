@@ -0,0 +1,117 @@
+/*
+ *	ld2410Task reading a scripted sensor on its own std::thread while the test consumes the frames it publishes. From the root of
+ *	the library...
+ *
+ *	g++ -std=gnu++11 -Isrc -Iextras/tests extras/tests/taskTest.cpp src/ld2410*.cpp -o taskTest -lpthread
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#include "ld2410Test.h"
+#include <ld2410Task.h>
+
+static void countFrame(const ld2410Reading &, void *context)
+{
+	(*static_cast<uint32_t *>(context))++;
+}
+
+static bool waitForFrames(ld2410Task &task, uint32_t frames)	//The task drains the sensor on its own, give it a second
+{
+	uint32_t started = millis();
+	while(task.published() + task.overflows() < frames && millis() - started < 1000)
+	{
+		delay(1);
+	}
+	return task.published() + task.overflows() == frames;
+}
+
+static void neverStarted()	//Destroying an idle task leaves the application's callback alone
+{
+	ld2410TestSensor sensor;
+	ld2410 radar;
+	radar.begin(sensor, false);
+	uint32_t frames = 0;
+	radar.setDataCallback(countFrame, &frames);
+	{
+		ld2410Task task(radar);
+	}
+	sensor.sendDataFrame(0x01, 100, 50, 0, 0);
+	radar.readAvailable();
+	LD2410_CHECK(frames == 1);
+}
+
+static void consumedWhileRunning()	//Frames are read from another thread as the task publishes them
+{
+	ld2410TestSensor sensor;
+	ld2410 radar;
+	radar.begin(sensor, false);
+	for(uint16_t i = 0; i < LD2410_TASK_QUEUE_LENGTH - 4; i++)	//Loaded up front, the task owns the sensor once started
+	{
+		sensor.sendDataFrame(0x01, 100 + i, 50, 0, 0);
+	}
+	ld2410Task task(radar);
+	LD2410_CHECK(task.start());
+	LD2410_CHECK(task.running());
+	LD2410_CHECK(task.start() == false);						//Already running
+	uint16_t received = 0;
+	bool inOrder = true;
+	ld2410Reading reading;
+	uint32_t started = millis();
+	while(received < LD2410_TASK_QUEUE_LENGTH - 4 && millis() - started < 1000)
+	{
+		if(task.read(reading))
+		{
+			inOrder = inOrder && reading.movingTargetDistance == 100 + received;
+			received++;
+		}
+		else
+		{
+			delay(1);
+		}
+	}
+	task.stop();
+	LD2410_CHECK(task.running() == false);
+	LD2410_CHECK(received == LD2410_TASK_QUEUE_LENGTH - 4);
+	LD2410_CHECK(inOrder);
+	LD2410_CHECK(task.published() == received);
+	LD2410_CHECK(task.overflows() == 0);
+	LD2410_CHECK(task.read(reading) == false);
+	uint32_t frames = 0;											//Stopped, so the radar can be used directly again
+	radar.setDataCallback(countFrame, &frames);
+	sensor.sendDataFrame(0x01, 100, 50, 0, 0);
+	radar.readAvailable();
+	LD2410_CHECK(frames == 1);
+}
+
+static void overflowing()	//Nobody reading, the queue keeps the oldest frames and counts the rest
+{
+	ld2410TestSensor sensor;
+	ld2410 radar;
+	radar.begin(sensor, false);
+	for(uint16_t i = 0; i < 2 * LD2410_TASK_QUEUE_LENGTH; i++)
+	{
+		sensor.sendDataFrame(0x02, 0, 0, 200 + i, 30);
+	}
+	ld2410Task task(radar);
+	LD2410_CHECK(task.start());
+	LD2410_CHECK(waitForFrames(task, 2 * LD2410_TASK_QUEUE_LENGTH));
+	task.stop();
+	LD2410_CHECK(task.published() == LD2410_TASK_QUEUE_LENGTH);
+	LD2410_CHECK(task.overflows() == LD2410_TASK_QUEUE_LENGTH);
+	LD2410_CHECK(task.queued() == LD2410_TASK_QUEUE_LENGTH);
+	ld2410Reading reading;
+	for(uint16_t i = 0; i < LD2410_TASK_QUEUE_LENGTH; i++)
+	{
+		LD2410_CHECK(task.read(reading) && reading.stationaryTargetDistance == 200 + i);
+	}
+}
+
+int main()
+{
+	neverStarted();
+	consumedWhileRunning();
+	overflowing();
+	return ld2410TestResult("taskTest");
+}
@@ -13,6 +13,71 @@
 #ifndef ld2410_cpp
 #define ld2410_cpp
 #include "ld2410.h"
+#include "ld2410Storage.h"
+
+#define LD2410_PHASE_IDLE 0			//States of the non-blocking command engine
+#define LD2410_PHASE_ENTERING 1
+#define LD2410_PHASE_WAITING 2
+#define LD2410_PHASE_LEAVING 3
+
+#define LD2410_CACHE_BLUETOOTH 0x80		//Alongside the LD2410_INFO_ flags, Bluetooth state is known
+#define LD2410_CACHE_FLAGS (LD2410_INFO_CONFIGURATION | LD2410_INFO_RESOLUTION | LD2410_CACHE_BLUETOOTH)
+#define LD2410_CACHE_VERSION 1			//First byte of the saved configuration
+#define LD2410_CACHE_LENGTH 27
+
+#define LD2410_ACK_DECODE_NONE 0		//What to do with the payload of each ACK
+#define LD2410_ACK_DECODE_CONFIGURATION 1
+#define LD2410_ACK_DECODE_FIRMWARE_VERSION 2
+#define LD2410_ACK_DECODE_RESOLUTION 3
+#define LD2410_ACK_DECODE_MAC 4
+#define LD2410_ACK_DECODE_ENGINEERING_STARTED 5
+#define LD2410_ACK_DECODE_ENGINEERING_ENDED 6
+
+struct ld2410_ack_definition_ {
+	uint8_t command;			//Opcode echoed in the ACK
+	uint8_t payload_length;		//Expected intra-frame data length
+	uint8_t decoder;			//One of LD2410_ACK_DECODE_
+	const char *name;			//For debugging, in flash
+};
+
+static const char ld2410_ack_name_60_[] PROGMEM = "setting max values";
+static const char ld2410_ack_name_61_[] PROGMEM = "current configuration";
+static const char ld2410_ack_name_62_[] PROGMEM = "engineering mode";
+static const char ld2410_ack_name_63_[] PROGMEM = "end engineering mode";
+static const char ld2410_ack_name_64_[] PROGMEM = "setting sensitivity values";
+static const char ld2410_ack_name_a0_[] PROGMEM = "firmware version";
+static const char ld2410_ack_name_a1_[] PROGMEM = "set baud rate";
+static const char ld2410_ack_name_a2_[] PROGMEM = "factory reset";
+static const char ld2410_ack_name_a3_[] PROGMEM = "restart";
+static const char ld2410_ack_name_a4_[] PROGMEM = "set Bluetooth";
+static const char ld2410_ack_name_a5_[] PROGMEM = "get MAC";
+static const char ld2410_ack_name_aa_[] PROGMEM = "set distance resolution";
+static const char ld2410_ack_name_ab_[] PROGMEM = "read distance resolution";
+static const char ld2410_ack_name_fe_[] PROGMEM = "leaving configuration mode";
+static const char ld2410_ack_name_ff_[] PROGMEM = "entering configuration mode";
+
+static const ld2410_ack_definition_ ld2410_ack_table_[] PROGMEM = {	//Every ACK the library understands, new opcodes only need adding here
+	{LD2410_CMD_SET_MAX_VALUES,			4,	LD2410_ACK_DECODE_NONE,					ld2410_ack_name_60_},
+	{LD2410_CMD_READ_CONFIGURATION,		28,	LD2410_ACK_DECODE_CONFIGURATION,		ld2410_ack_name_61_},
+	{LD2410_CMD_START_ENGINEERING_MODE,	4,	LD2410_ACK_DECODE_ENGINEERING_STARTED,	ld2410_ack_name_62_},
+	{LD2410_CMD_END_ENGINEERING_MODE,	4,	LD2410_ACK_DECODE_ENGINEERING_ENDED,	ld2410_ack_name_63_},
+	{LD2410_CMD_SET_GATE_SENSITIVITY,	4,	LD2410_ACK_DECODE_NONE,					ld2410_ack_name_64_},
+	{LD2410_CMD_READ_FIRMWARE_VERSION,	12,	LD2410_ACK_DECODE_FIRMWARE_VERSION,		ld2410_ack_name_a0_},
+	{LD2410_CMD_SET_BAUD_RATE,			4,	LD2410_ACK_DECODE_NONE,					ld2410_ack_name_a1_},
+	{LD2410_CMD_FACTORY_RESET,			4,	LD2410_ACK_DECODE_NONE,					ld2410_ack_name_a2_},
+	{LD2410_CMD_RESTART,				4,	LD2410_ACK_DECODE_NONE,					ld2410_ack_name_a3_},
+	{LD2410_CMD_SET_BLUETOOTH,			4,	LD2410_ACK_DECODE_NONE,					ld2410_ack_name_a4_},
+	{LD2410_CMD_GET_MAC,				10,	LD2410_ACK_DECODE_MAC,					ld2410_ack_name_a5_},
+	{LD2410_CMD_SET_RESOLUTION,			4,	LD2410_ACK_DECODE_NONE,					ld2410_ack_name_aa_},
+	{LD2410_CMD_READ_RESOLUTION,		6,	LD2410_ACK_DECODE_RESOLUTION,			ld2410_ack_name_ab_},
+	{LD2410_CMD_LEAVE_CONFIGURATION,	4,	LD2410_ACK_DECODE_NONE,					ld2410_ack_name_fe_},
+	{LD2410_CMD_ENTER_CONFIGURATION,	8,	LD2410_ACK_DECODE_NONE,					ld2410_ack_name_ff_},
+};
+#define LD2410_ACK_TABLE_LENGTH (sizeof(ld2410_ack_table_) / sizeof(ld2410_ack_table_[0]))
+
+static const uint32_t ld2410_baud_rates_[] PROGMEM = {9600, 19200, 38400, 57600, 115200, 230400, 256000, 460800};	//Sent to the sensor as the index + 1
+static const uint8_t ld2410_baud_search_order_[] PROGMEM = {6, 4, 5, 7, 3, 2, 1, 0};	//Most likely first, starting with the default
+#define LD2410_BAUD_RATES (sizeof(ld2410_baud_rates_) / sizeof(ld2410_baud_rates_[0]))
 
 
 ld2410::ld2410()	//Constructor function
@@ -67,6 +132,76 @@ bool ld2410::begin(Stream &radarStream, bool waitForRadar)	{
 	return false;
 }
 
+bool ld2410::begin(Stream &radarStream, ld2410BaudCallback baudCallback, void *context, bool waitForRadar)	{
+	radar_uart_ = &radarStream;
+	bool detected_ = detectBaudRate(baudCallback, context) > 0;
+	if(detected_ == false)	//It may be in configuration mode and not sending, try the default
+	{
+		if(debug_uart_ != nullptr)
+		{
+			debug_uart_->println(F("\nLD2410 baud rate not detected"));
+		}
+		baudCallback(LD2410_DEFAULT_BAUD_RATE, context);
+	}
+	return begin(radarStream, waitForRadar) && (detected_ || waitForRadar);
+}
+
+bool ld2410::beginPassive(Stream &radarStream, uint16_t timeout)	{
+	radar_uart_ = &radarStream;		//Set the stream used for the LD2410
+	if(debug_uart_ != nullptr)
+	{
+		debug_uart_->println(F("ld2410 started"));
+	}
+	uint32_t started_ = millis();
+	while(millis() - started_ < timeout)	//The sensor streams data frames, the first one proves it is there
+	{
+		if(read_frame_() && ack_frame_ == false)
+		{
+			return true;
+		}
+	}
+	if(debug_uart_ != nullptr)
+	{
+		debug_uart_->print(F("\nLD2410 no data"));
+	}
+	return false;
+}
+
+bool ld2410::infoAvailable(uint8_t info)
+{
+	if((info_fetched_ & info) == info)
+	{
+		return true;
+	}
+	uint8_t missing_ = info & ~info_fetched_ & ~info_attempted_;	//Each is only asked for once, use the blocking methods to retry
+	if(missing_ == 0 || radar_uart_ == nullptr || beginTransaction() == false)
+	{
+		return false;
+	}
+	uint8_t queued_ = 0;	//A small LD2410_MAX_QUEUED_COMMANDS may not hold them all, the rest are asked for next time
+	if((missing_ & LD2410_INFO_FIRMWARE) && queueCommand(LD2410_CMD_READ_FIRMWARE_VERSION))
+	{
+		queued_ |= LD2410_INFO_FIRMWARE;
+	}
+	if((missing_ & LD2410_INFO_MAC) && queueCommand(LD2410_CMD_GET_MAC))
+	{
+		queued_ |= LD2410_INFO_MAC;
+	}
+	if((missing_ & LD2410_INFO_CONFIGURATION) && queueCommand(LD2410_CMD_READ_CONFIGURATION))
+	{
+		queued_ |= LD2410_INFO_CONFIGURATION;
+	}
+	if((missing_ & LD2410_INFO_RESOLUTION) && queueCommand(LD2410_CMD_READ_RESOLUTION))
+	{
+		queued_ |= LD2410_INFO_RESOLUTION;
+	}
+	if(commitTransaction(false))
+	{
+		info_attempted_ |= queued_;
+	}
+	return false;
+}
+
 void ld2410::debug(Stream &terminalStream)
 {
 	debug_uart_ = &terminalStream;		//Set the stream used for the terminal
@@ -78,6 +213,24 @@ void ld2410::debug(Stream &terminalStream)
 	#endif
 }
 
+void ld2410::setDataCallback(ld2410DataCallback callback, void *context)
+{
+	data_callback_ = callback;
+	data_callback_context_ = context;
+}
+
+void ld2410::setAckCallback(ld2410AckCallback callback, void *context)
+{
+	ack_callback_ = callback;
+	ack_callback_context_ = context;
+}
+
+void ld2410::setInputCallback(ld2410InputCallback callback, void *context)
+{
+	input_callback_ = callback;
+	input_callback_context_ = context;
+}
+
 bool ld2410::isConnected()
 {
 	if(millis() - radar_uart_last_packet_ < radar_uart_timeout)	//Use the last reading
@@ -93,7 +246,20 @@ bool ld2410::isConnected()
 
 bool ld2410::read()
 {
-	return read_frame_();
+	bool frame_read_ = read_frame_();
+	poll_command_();
+	return frame_read_;
+}
+
+ld2410LinkStatistics ld2410::statistics()
+{
+	statistics_.lastGoodFrame = radar_uart_last_packet_;
+	return statistics_;
+}
+
+void ld2410::resetStatistics()
+{
+	memset(&statistics_, 0, sizeof(statistics_));
 }
 
 bool ld2410::presenceDetected()
@@ -160,993 +326,1140 @@ uint16_t ld2410::detectionDistance()
 	return detection_distance_;
 }
 
+uint16_t ld2410::readAvailable(uint16_t *bytesPending, uint16_t maxBytes)
+{
+	uint16_t frames_decoded_ = 0;
+	if(radar_uart_ == nullptr)
+	{
+		return 0;
+	}
+	int bytes_to_read_ = radar_uart_ -> available();	//Only drain what is already buffered, so this always returns
+	if(maxBytes > 0 && bytes_to_read_ > maxBytes)
+	{
+		bytes_to_read_ = maxBytes;
+	}
+	uint8_t chunk_[LD2410_READ_CHUNK_LENGTH];
+	while(bytes_to_read_ > 0)
+	{
+		size_t chunk_length_ = radar_uart_ -> readBytes(chunk_, bytes_to_read_ < LD2410_READ_CHUNK_LENGTH ? bytes_to_read_ : LD2410_READ_CHUNK_LENGTH);
+		if(chunk_length_ == 0)
+		{
+			break;
+		}
+		statistics_.bytesIn += chunk_length_;
+		if(input_callback_ != nullptr)
+		{
+			input_callback_(chunk_, chunk_length_, input_callback_context_);
+		}
+		for(size_t i = 0; i < chunk_length_; i++)
+		{
+			frames_decoded_ += process_byte_(chunk_[i]);
+		}
+		bytes_to_read_ -= chunk_length_;
+	}
+	poll_command_();
+	if(bytesPending != nullptr)
+	{
+		*bytesPending = radar_uart_ -> available();	//Anything left over or that arrived while parsing
+	}
+	return frames_decoded_;
+}
+
+uint16_t ld2410::feed(const uint8_t *data, size_t length)
+{
+	uint16_t frames_decoded_ = 0;
+	while(length > 0)	//Never waits, the work is proportional to length
+	{
+		uint8_t space_ = LD2410_RING_BUFFER_LENGTH - (uint8_t)(ring_head_ - ring_tail_);
+		uint8_t block_ = length < space_ ? length : space_;
+		uint8_t start_ = ring_head_ & (LD2410_RING_BUFFER_LENGTH - 1);	//Copy in at most two pieces, the ring may wrap
+		uint8_t first_part_ = LD2410_RING_BUFFER_LENGTH - start_;
+		if(first_part_ > block_)
+		{
+			first_part_ = block_;
+		}
+		memcpy(&radar_ring_buffer_[start_], data, first_part_);
+		memcpy(radar_ring_buffer_, &data[first_part_], block_ - first_part_);
+		ring_head_ += block_;
+		frames_decoded_ += ring_filled_(block_);
+		data += block_;
+		length -= block_;
+	}
+	return frames_decoded_;	//ACKs are only recorded, read() and readAvailable() act on them and send any more commands
+}
+
 bool ld2410::read_frame_()
 {
-	if(radar_uart_ -> available())
+	if(radar_uart_ != nullptr && radar_uart_ -> available())
+	{
+		return input_byte_(radar_uart_ -> read()) > 0;
+	}
+	return false;
+}
+
+uint8_t ld2410::input_byte_(uint8_t byte_read_)
+{
+	statistics_.bytesIn++;
+	if(input_callback_ != nullptr)
+	{
+		input_callback_(&byte_read_, 1, input_callback_context_);
+	}
+	return process_byte_(byte_read_);
+}
+
+uint8_t ld2410::process_byte_(uint8_t byte_read_)
+{
+	if((uint8_t)(ring_head_ - ring_tail_) == LD2410_RING_BUFFER_LENGTH)	//Only possible if the ring is configured smaller than a frame
+	{
+		ring_tail_++;
+		statistics_.overruns++;
+		statistics_.bytesDiscarded++;
+	}
+	radar_ring_buffer_[ring_head_++ & (LD2410_RING_BUFFER_LENGTH - 1)] = byte_read_;
+	return assemble_frames_();
+}
+
+uint8_t ld2410::ring_filled_(uint8_t added_)
+{
+	statistics_.bytesIn += added_;
+	if(input_callback_ != nullptr)	//In at most two pieces, the new bytes may wrap
+	{
+		uint8_t start_ = (uint8_t)(ring_head_ - added_) & (LD2410_RING_BUFFER_LENGTH - 1);
+		uint8_t first_part_ = LD2410_RING_BUFFER_LENGTH - start_;
+		if(first_part_ > added_)
+		{
+			first_part_ = added_;
+		}
+		input_callback_(&radar_ring_buffer_[start_], first_part_, input_callback_context_);
+		if(added_ > first_part_)
+		{
+			input_callback_(radar_ring_buffer_, added_ - first_part_, input_callback_context_);
+		}
+	}
+	return assemble_frames_();
+}
+
+void ld2410::poll_command_()
+{
+	uint8_t count_ = received_ack_count_;	//Copied, a callback may start another command and read more
+	uint8_t commands_[LD2410_PIPELINE_DEPTH + 1];
+	bool success_[LD2410_PIPELINE_DEPTH + 1];
+	memcpy(commands_, received_ack_command_, count_);
+	memcpy(success_, received_ack_success_, count_);
+	received_ack_count_ = 0;
+	for(uint8_t i = 0; i < count_; i++)	//In the order they arrived
+	{
+		command_ack_received_(commands_[i], success_[i]);
+	}
+	if(command_phase_ != LD2410_PHASE_IDLE)
+	{
+		check_command_timeout_();
+	}
+}
+
+uint8_t ld2410::ring_byte_(uint8_t offset)
+{
+	return radar_ring_buffer_[(uint8_t)(ring_tail_ + offset) & (LD2410_RING_BUFFER_LENGTH - 1)];
+}
+
+uint8_t ld2410::assemble_frames_()
+{
+	uint8_t frames_decoded_ = 0;
+	while(true)
 	{
-		if(frame_started_ == false)
+		uint8_t buffered_ = ring_head_ - ring_tail_;
+		while(buffered_ > 0 && ring_byte_(0) != 0xF4 && ring_byte_(0) != 0xFD)	//Skip anything that can't start a frame
+		{
+			ring_tail_++;
+			buffered_--;
+			statistics_.bytesDiscarded++;
+		}
+		if(buffered_ == 0)
+		{
+			return frames_decoded_;
+		}
+		bool ack_ = ring_byte_(0) == 0xFD;
+		bool header_valid_ = true;
+		for(uint8_t i = 1; i < 4 && i < buffered_; i++)		//Check as much of the header as has arrived
+		{
+			if(ring_byte_(i) != (ack_ ? 0xFD : 0xF4) - i)	//Headers count down, F4 F3 F2 F1 or FD FC FB FA
+			{
+				header_valid_ = false;
+				break;
+			}
+		}
+		if(header_valid_ == false)
+		{
+			ring_tail_++;	//Resynchronise from the next candidate header, which may already be buffered
+			statistics_.bytesDiscarded++;
+			continue;
+		}
+		if(buffered_ < 6)	//Wait for the length
+		{
+			return frames_decoded_;
+		}
+		uint16_t data_length_ = ring_byte_(4) + (ring_byte_(5) << 8);
+		if(data_length_ > LD2410_MAX_FRAME_LENGTH - 10)	//Don't wait for a footer that can never fit, checked before adding the header and footer so it can't wrap
+		{
+			if(log_<LD2410_LOG_DATA, LD2410_LOG_ERROR>())
+			{
+				debug_uart_->print(F("\nLD2410 frame length invalid: "));
+				debug_uart_->print(data_length_);
+			}
+			ring_tail_++;
+			statistics_.overruns++;
+			statistics_.bytesDiscarded++;
+			continue;
+		}
+		uint8_t frame_length_ = data_length_ + 10;	//At least the header and footer, so a frame always moves ring_tail_ on
+		if(buffered_ < frame_length_)	//Wait for the rest of the frame
+		{
+			return frames_decoded_;
+		}
+		uint8_t footer_ = ack_ ? 0x04 : 0xF8;	//Footers count down, F8 F7 F6 F5 or 04 03 02 01
+		if(	ring_byte_(frame_length_ - 4) != footer_ ||
+			ring_byte_(frame_length_ - 3) != footer_ - 1 ||
+			ring_byte_(frame_length_ - 2) != footer_ - 2 ||
+			ring_byte_(frame_length_ - 1) != footer_ - 3
+		)
+		{
+			if(log_<LD2410_LOG_DATA, LD2410_LOG_ERROR>())
+			{
+				debug_uart_->print(F("\nLD2410 frame footer missing, resynchronising"));
+			}
+			ring_tail_++;
+			statistics_.lengthErrors++;
+			statistics_.bytesDiscarded++;
+			continue;
+		}
+		uint8_t start_ = ring_tail_ & (LD2410_RING_BUFFER_LENGTH - 1);	//Copy out in at most two pieces, the frame may wrap
+		uint8_t first_part_ = LD2410_RING_BUFFER_LENGTH - start_;
+		if(first_part_ > frame_length_)
+		{
+			first_part_ = frame_length_;
+		}
+		memcpy(radar_data_frame_, &radar_ring_buffer_[start_], first_part_);
+		memcpy(&radar_data_frame_[first_part_], radar_ring_buffer_, frame_length_ - first_part_);
+		radar_data_frame_position_ = frame_length_;
+		ring_tail_ += frame_length_;
+		ack_frame_ = ack_;
+		if(ack_frame_ == false)
 		{
-			uint8_t byte_read_ = radar_uart_ -> read();
-			if(byte_read_ == 0xF4)
+			if(parse_data_frame_())
 			{
-				#ifdef LD2410_DEBUG_DATA
-				if(debug_uart_ != nullptr)
+				if(log_<LD2410_LOG_DATA, LD2410_LOG_VERBOSE>())
 				{
-					debug_uart_->print(F("\nRcvd : 00 "));
+					debug_uart_->print(F("parsed data OK"));
 				}
-				#endif
-				radar_data_frame_[radar_data_frame_position_++] = byte_read_;
-				frame_started_ = true;
-				ack_frame_ = false;
+				frames_decoded_++;
 			}
-			else if(byte_read_ == 0xFD)
+			else
 			{
-				#ifdef LD2410_DEBUG_COMMANDS
-				if(debug_uart_ != nullptr)
+				if(log_<LD2410_LOG_DATA, LD2410_LOG_ERROR>())
 				{
-					debug_uart_->print(F("\nRcvd : 00 "));
+					debug_uart_->print(F("failed to parse data"));
 				}
-				#endif
-				radar_data_frame_[radar_data_frame_position_++] = byte_read_;
-				frame_started_ = true;
-				ack_frame_ = true;
 			}
 		}
 		else
 		{
-			if(radar_data_frame_position_ < LD2410_MAX_FRAME_LENGTH)
+			bool command_parsed_ = parse_command_frame_();
+			ack_received_ = true;
+			if(ack_callback_ != nullptr)
 			{
-				#ifdef LD2410_DEBUG_DATA
-				if(debug_uart_ != nullptr && ack_frame_ == false)
-				{
-					if(radar_data_frame_position_ < 0x10)
-					{
-						debug_uart_->print('0');
-					}
-					debug_uart_->print(radar_data_frame_position_, HEX);
-					debug_uart_->print(' ');
-				}
-				#endif
-				#ifdef LD2410_DEBUG_COMMANDS
-				if(debug_uart_ != nullptr && ack_frame_ == true)
-				{
-					if(radar_data_frame_position_ < 0x10)
-					{
-						debug_uart_->print('0');
-					}
-					debug_uart_->print(radar_data_frame_position_, HEX);
-					debug_uart_->print(' ');
-				}
-				#endif
-				radar_data_frame_[radar_data_frame_position_++] = radar_uart_ -> read();
-				if(radar_data_frame_position_ > 7)	//Can check for start and end
+				ack_callback_(latest_ack_, latest_command_success_, ack_callback_context_);
+			}
+			if(command_phase_ != LD2410_PHASE_IDLE && received_ack_count_ < LD2410_PIPELINE_DEPTH + 1)	//Acted on by poll_command_(), so parsing never writes to the UART
+			{
+				received_ack_command_[received_ack_count_] = latest_ack_;
+				received_ack_success_[received_ack_count_++] = latest_command_success_;
+			}
+			if(command_parsed_)
+			{
+				if(log_<LD2410_LOG_COMMANDS, LD2410_LOG_INFO>())
 				{
-					if(	radar_data_frame_[0]                              == 0xF4 &&	//Data frame end state
-						radar_data_frame_[1]                              == 0xF3 &&
-						radar_data_frame_[2]                              == 0xF2 &&
-						radar_data_frame_[3]                              == 0xF1 &&
-						radar_data_frame_[radar_data_frame_position_ - 4] == 0xF8 &&
-						radar_data_frame_[radar_data_frame_position_ - 3] == 0xF7 &&
-						radar_data_frame_[radar_data_frame_position_ - 2] == 0xF6 &&
-						radar_data_frame_[radar_data_frame_position_ - 1] == 0xF5
-					)
-					{
-						if(parse_data_frame_())
-						{
-							#ifdef LD2410_DEBUG_DATA
-							if(debug_uart_ != nullptr)
-							{
-								debug_uart_->print(F("parsed data OK"));
-							}
-							#endif
-							frame_started_ = false;
-							radar_data_frame_position_ = 0;
-							return true;
-						}
-						else
-						{
-							#ifdef LD2410_DEBUG_DATA
-							if(debug_uart_ != nullptr)
-							{
-								debug_uart_->print(F("failed to parse data"));
-							}
-							#endif
-							frame_started_ = false;
-							radar_data_frame_position_ = 0;
-						}
-					}
-					else if(radar_data_frame_[0]                              == 0xFD &&	//Command frame end state
-							radar_data_frame_[1]                              == 0xFC &&
-							radar_data_frame_[2]                              == 0xFB &&
-							radar_data_frame_[3]                              == 0xFA &&
-							radar_data_frame_[radar_data_frame_position_ - 4] == 0x04 &&
-							radar_data_frame_[radar_data_frame_position_ - 3] == 0x03 &&
-							radar_data_frame_[radar_data_frame_position_ - 2] == 0x02 &&
-							radar_data_frame_[radar_data_frame_position_ - 1] == 0x01
-						)
-					{
-						if(parse_command_frame_())
-						{
-							#ifdef LD2410_DEBUG_COMMANDS
-							if(debug_uart_ != nullptr)
-							{
-								debug_uart_->print(F("parsed command OK"));
-							}
-							#endif
-							frame_started_ = false;
-							radar_data_frame_position_ = 0;
-							return true;
-						}
-						else
-						{
-							#ifdef LD2410_DEBUG_COMMANDS
-							if(debug_uart_ != nullptr)
-							{
-								debug_uart_->print(F("failed to parse command"));
-							}
-							#endif
-							frame_started_ = false;
-							radar_data_frame_position_ = 0;
-						}
-					}
+					debug_uart_->print(F("parsed command OK"));
 				}
+				frames_decoded_++;
 			}
 			else
 			{
-				#if defined(LD2410_DEBUG_DATA) || defined(LD2410_DEBUG_COMMANDS)
-				if(debug_uart_ != nullptr)
+				if(log_<LD2410_LOG_COMMANDS, LD2410_LOG_INFO>())
 				{
-					debug_uart_->print(F("\nLD2410 frame overran: "));
-					debug_uart_->print(radar_data_frame_position_);
-					debug_uart_->print(F(" Len: "));
-					debug_uart_->print(radar_data_frame_[4]);
+					debug_uart_->print(F("failed to parse command"));
 				}
-				#endif
-				frame_started_ = false;
-				radar_data_frame_position_ = 0;
 			}
 		}
 	}
-	return false;
 }
 
 void ld2410::print_frame_()
 {
 	if(debug_uart_ != nullptr)
 	{
-		if(ack_frame_ == true)
-		{
-			debug_uart_->print(F("\nCmnd : "));
-		}
-		else
+		static const char hex_[] = "0123456789ABCDEF";
+		char line_[LD2410_MAX_FRAME_LENGTH * 3 + 8];	//Format the whole frame first so it goes out in one write
+		uint8_t length_ = 0;
+		const char *label_ = ack_frame_ ? "\nCmnd : " : "\nData : ";
+		while(*label_ != 0)
 		{
-			debug_uart_->print(F("\nData : "));
+			line_[length_++] = *label_++;
 		}
 		for(uint8_t i = 0; i < radar_data_frame_position_ ; i ++)
 		{
-			if(radar_data_frame_[i] < 0x10)
-			{
-				debug_uart_->print('0');
-			}
-			debug_uart_->print(radar_data_frame_[i],HEX);
-			debug_uart_->print(' ');
+			line_[length_++] = hex_[radar_data_frame_[i] >> 4];
+			line_[length_++] = hex_[radar_data_frame_[i] & 0x0F];
+			line_[length_++] = ' ';
 		}
+		debug_uart_->write((const uint8_t *)line_, length_);
 	}
 }
 
+void ld2410::print_padded_(uint8_t value)
+{
+	if(value < 100)
+	{
+		debug_uart_->print('0');
+	}
+	if(value < 10)
+	{
+		debug_uart_->print('0');
+	}
+	debug_uart_->print(value);
+	debug_uart_->print(' ');
+}
+
 bool ld2410::parse_data_frame_()
 {
-	uint16_t intra_frame_data_length_ = radar_data_frame_[4] + (radar_data_frame_[5] << 8);
-	if(radar_data_frame_position_ == intra_frame_data_length_ + 10)
+	ld2410Reading reading_;
+	uint8_t result_ = ld2410Codec::decodeData(radar_data_frame_, radar_data_frame_position_, reading_);
+	if(result_ == LD2410_DECODE_OK)
 	{
-		#ifdef LD2410_DEBUG_DATA
-		if(debug_uart_ != nullptr && ack_frame_ == false)
+		if(log_<LD2410_LOG_DATA, LD2410_LOG_VERBOSE>())
 		{
 			print_frame_();
 		}
-		#endif
-		#ifdef LD2410_DEBUG_COMMANDS
-		if(debug_uart_ != nullptr && ack_frame_ == true)
+		target_type_ = reading_.targetType;
+		moving_target_distance_ = reading_.movingTargetDistance;
+		moving_target_energy_ = reading_.movingTargetEnergy;
+		stationary_target_distance_ = reading_.stationaryTargetDistance;
+		stationary_target_energy_ = reading_.stationaryTargetEnergy;
+		detection_distance_ = reading_.detectionDistance;
+		if(reading_.engineeringData)
 		{
-			print_frame_();
+			memcpy(eng_mode_motion, reading_.movingGateEnergy, LD2410_GATES);
+			memcpy(eng_mode_stationary, reading_.stationaryGateEnergy, LD2410_GATES);
 		}
-		#endif
-		if(radar_data_frame_[6] == 0x01 && radar_data_frame_[7] == 0xAA)	//Engineering mode data
+		bool engineering_ = radar_data_frame_[6] == 0x01;
+		if(log_<LD2410_LOG_PARSE, LD2410_LOG_INFO>())
 		{
-			target_type_ = radar_data_frame_[8];
-			
-			moving_target_distance_ = radar_data_frame_[9] + (radar_data_frame_[10] << 8);
-			moving_target_energy_ = radar_data_frame_[11];
-
-			stationary_target_distance_ = radar_data_frame_[12] + (radar_data_frame_[13] << 8);
-			stationary_target_energy_ = radar_data_frame_[14];
-
-			detection_distance_ = radar_data_frame_[15] + (radar_data_frame_[16] << 8);
-
-			if (intra_frame_data_length_ > 30)
+			if(engineering_)
 			{
-				//Read out movement and stationary arrays
-				int gates = 9;
-				int movement_offset = 19;
-				int stationary_offset = 28;
-
-				for(int i = 0; i < gates; i++) {
-					eng_mode_motion[i] = radar_data_frame_[movement_offset + i];
-					eng_mode_stationary[i] = radar_data_frame_[stationary_offset + i];
-				}
+				debug_uart_->print(F("\nEngineering data - "));
 			}
-
-			#ifdef LD2410_DEBUG_PARSE
-			if(debug_uart_ != nullptr)
+			else
+			{
+				debug_uart_->print(F("\nNormal data - "));
+			}
+			if(target_type_ == 0x00)
+			{
+				debug_uart_->print(F("no target"));
+			}
+			else if(target_type_ == 0x01)
+			{
+				debug_uart_->print(F("moving target:"));
+			}
+			else if(target_type_ == 0x02)
+			{
+				debug_uart_->print(F("stationary target:"));
+			}
+			else if(target_type_ == 0x03)
+			{
+				debug_uart_->print(F("moving & stationary targets:"));
+			}
+			if(target_type_ & 0x01)
+			{
+				debug_uart_->print(F(" moving at "));
+				debug_uart_->print(moving_target_distance_);
+				debug_uart_->print(F("cm power "));
+				debug_uart_->print(moving_target_energy_);
+			}
+			if(target_type_ & 0x02)
+			{
+				debug_uart_->print(F(" stationary at "));
+				debug_uart_->print(stationary_target_distance_);
+				debug_uart_->print(F("cm power "));
+				debug_uart_->print(stationary_target_energy_);
+			}
+			if(engineering_)
 			{
-				debug_uart_->print(F("\nEngineering data - "));
-				if(target_type_ == 0x00)
-				{
-					debug_uart_->print(F("no target"));
-				}
-				else if(target_type_ == 0x01)
-				{
-					debug_uart_->print(F("moving target:"));
-				}
-				else if(target_type_ == 0x02)
-				{
-					debug_uart_->print(F("stationary target:"));
-				}
-				else if(target_type_ == 0x03)
-				{
-					debug_uart_->print(F("moving & stationary targets:"));
-				}
-				if(target_type_ & 0x01)
-				{
-					debug_uart_->print(F(" moving at "));
-					debug_uart_->print(moving_target_distance_);
-					debug_uart_->print(F("cm power "));
-					debug_uart_->print(moving_target_energy_);
-				}
-				if(target_type_ & 0x02)
-				{
-					debug_uart_->print(F(" stationary at "));
-					debug_uart_->print(stationary_target_distance_);
-					debug_uart_->print(F("cm power "));
-					debug_uart_->print(stationary_target_energy_);
-				}
 				debug_uart_->print(F(" distance at: "));
 				debug_uart_->print(detection_distance_);
 				debug_uart_->println();
-
-				if (intra_frame_data_length_ > 30)
-				{
-					int gates = 9;
-
-					debug_uart_->print(F("Eng Data: 0   1   2   3   4   5   6   7   8                 0   1   2   3   4   5   6   7   8\nMovement:["));
-
-					for(int i = 0; i < gates; i++) {
-						debug_uart_->printf("%03u ",eng_mode_motion[i]);
-					}					
-					debug_uart_->print(F("] Stationary:["));
-					for(int i = 0; i < gates; i++) {
-						debug_uart_->printf("%03u ",eng_mode_stationary[i]);
-					}
-					debug_uart_->print(F("]\n"));
-
-				}
 			}
-			#endif
-			radar_uart_last_packet_ = millis();
-			return true;
-		}
-		else if(intra_frame_data_length_ == 13 && radar_data_frame_[6] == 0x02 && radar_data_frame_[7] == 0xAA && radar_data_frame_[17] == 0x55 && radar_data_frame_[18] == 0x00)	//Normal target data
-		{
-			target_type_ = radar_data_frame_[8];
-			//moving_target_distance_ = radar_data_frame_[9] + (radar_data_frame_[10] << 8);
-			stationary_target_distance_ = radar_data_frame_[9] + (radar_data_frame_[10] << 8);
-			stationary_target_energy_ = radar_data_frame_[14];
-			moving_target_energy_ = radar_data_frame_[11];
-			//stationary_target_distance_ = radar_data_frame_[12] + (radar_data_frame_[13] << 8);
-			moving_target_distance_ = radar_data_frame_[15] + (radar_data_frame_[16] << 8);
-			#ifdef LD2410_DEBUG_PARSE
-			if(debug_uart_ != nullptr)
+			if(reading_.engineeringData)
 			{
-				debug_uart_->print(F("\nNormal data - "));
-				if(target_type_ == 0x00)
-				{
-					debug_uart_->print(F("no target"));
-				}
-				else if(target_type_ == 0x01)
-				{
-					debug_uart_->print(F("moving target:"));
-				}
-				else if(target_type_ == 0x02)
-				{
-					debug_uart_->print(F("stationary target:"));
-				}
-				else if(target_type_ == 0x03)
-				{
-					debug_uart_->print(F("moving & stationary targets:"));
-				}
-				if(radar_data_frame_[8] & 0x01)
-				{
-					debug_uart_->print(F(" moving at "));
-					debug_uart_->print(moving_target_distance_);
-					debug_uart_->print(F("cm power "));
-					debug_uart_->print(moving_target_energy_);
+				debug_uart_->print(F("Eng Data: 0   1   2   3   4   5   6   7   8                 0   1   2   3   4   5   6   7   8\nMovement:["));
+				for(uint8_t i = 0; i < LD2410_GATES; i++) {
+					print_padded_(eng_mode_motion[i]);
 				}
-				if(radar_data_frame_[8] & 0x02)
-				{
-					debug_uart_->print(F(" stationary at "));
-					debug_uart_->print(stationary_target_distance_);
-					debug_uart_->print(F("cm power "));
-					debug_uart_->print(stationary_target_energy_);
+				debug_uart_->print(F("] Stationary:["));
+				for(uint8_t i = 0; i < LD2410_GATES; i++) {
+					print_padded_(eng_mode_stationary[i]);
 				}
+				debug_uart_->print(F("]\n"));
 			}
-			#endif
-			radar_uart_last_packet_ = millis();
-			return true;
+		}
+		radar_uart_last_packet_ = millis();
+		if(engineering_)
+		{
+			statistics_.engineeringFrames++;
 		}
 		else
 		{
-			#ifdef LD2410_DEBUG_DATA
-			if(debug_uart_ != nullptr)
-			{
-				debug_uart_->print(F("\nUnknown frame type"));
-			}
-			#endif
+			statistics_.dataFrames++;
+		}
+		notify_data_(reading_);
+		return true;
+	}
+	else if(result_ == LD2410_DECODE_UNKNOWN)
+	{
+		statistics_.unknownFrames++;
+		if(log_<LD2410_LOG_DATA, LD2410_LOG_ERROR>())
+		{
+			debug_uart_->print(F("\nUnknown frame type"));
 			print_frame_();
 		}
 	}
 	else
 	{
-		#ifdef LD2410_DEBUG_DATA
-		if(debug_uart_ != nullptr)
+		statistics_.lengthErrors++;
+		if(log_<LD2410_LOG_DATA, LD2410_LOG_ERROR>())
 		{
 			debug_uart_->print(F("\nFrame length unexpected: "));
 			debug_uart_->print(radar_data_frame_position_);
 			debug_uart_->print(F(" not "));
-			debug_uart_->print(intra_frame_data_length_ + 10);
+			debug_uart_->print(ld2410Codec::dataLength(radar_data_frame_) + 10);
 		}
-		#endif
 	}
 	return false;
 }
 
+void ld2410::notify_data_(const ld2410Reading &reading_)
+{
+	if(data_callback_ != nullptr)
+	{
+		data_callback_(reading_, data_callback_context_);
+	}
+}
+
 bool ld2410::parse_command_frame_()
 {
-	uint16_t intra_frame_data_length_ = radar_data_frame_[4] + (radar_data_frame_[5] << 8);
-	#ifdef LD2410_DEBUG_COMMANDS
-	if(debug_uart_ != nullptr)
+	ld2410Ack ack_;
+	if(ld2410Codec::decodeAck(radar_data_frame_, radar_data_frame_position_, ack_) == false)	//Too short to carry a status
+	{
+		latest_ack_ = radar_data_frame_[6];
+		latest_command_success_ = false;
+		statistics_.unknownFrames++;
+		return false;
+	}
+	if(log_<LD2410_LOG_COMMANDS, LD2410_LOG_INFO>())
 	{
 		print_frame_();
 		debug_uart_->print(F("\nACK frame payload: "));
-		debug_uart_->print(intra_frame_data_length_);
+		debug_uart_->print(ack_.dataLength);
 		debug_uart_->print(F(" bytes"));
 	}
-	#endif
-	latest_ack_ = radar_data_frame_[6];
-	latest_command_success_ = (radar_data_frame_[8] == 0x00 && radar_data_frame_[9] == 0x00);
-	if(intra_frame_data_length_ == 8 && latest_ack_ == 0xFF)
+	latest_ack_ = ack_.command;
+	latest_command_success_ = ack_.success;
+	uint8_t entry_ = 0;
+	while(entry_ < LD2410_ACK_TABLE_LENGTH && pgm_read_byte(&ld2410_ack_table_[entry_].command) != latest_ack_)
 	{
-		#ifdef LD2410_DEBUG_COMMANDS
-		if(debug_uart_ != nullptr)
-		{
-			debug_uart_->print(F("\nACK for entering configuration mode: "));
-		}
-		#endif
-		if(latest_command_success_)
-		{
-			radar_uart_last_packet_ = millis();
-			#ifdef LD2410_DEBUG_COMMANDS
-			if(debug_uart_ != nullptr)
-			{
-				debug_uart_->print(F("OK"));
-			}
-			#endif
-			return true;
-		}
-		else
-		{
-			if(debug_uart_ != nullptr)
-			{
-				debug_uart_->print(F("failed"));
-			}
-			return false;
-		}
+		entry_++;
 	}
-	else if(intra_frame_data_length_ == 4 && latest_ack_ == 0xFE)
+	if(entry_ == LD2410_ACK_TABLE_LENGTH || ack_.dataLength != pgm_read_byte(&ld2410_ack_table_[entry_].payload_length))
 	{
-		#ifdef LD2410_DEBUG_COMMANDS
-		if(debug_uart_ != nullptr)
+		statistics_.unknownFrames++;
+		if(log_<LD2410_LOG_COMMANDS, LD2410_LOG_ERROR>())
 		{
-			debug_uart_->print(F("\nACK for leaving configuration mode: "));
-		}
-		#endif
-		if(latest_command_success_)
-		{
-			radar_uart_last_packet_ = millis();
-			#ifdef LD2410_DEBUG_COMMANDS
-			if(debug_uart_ != nullptr)
-			{
-				debug_uart_->print(F("OK"));
-			}
-			#endif
-			return true;
-		}
-		else
-		{
-			if(debug_uart_ != nullptr)
-			{
-				debug_uart_->print(F("failed"));
-			}
-			return false;
+			debug_uart_->print(F("\nUnknown ACK"));
 		}
+		return false;
 	}
-	else if(intra_frame_data_length_ == 4 && latest_ack_ == 0x60)
+	if(log_<LD2410_LOG_COMMANDS, LD2410_LOG_INFO>())
 	{
-		#ifdef LD2410_DEBUG_COMMANDS
-		if(debug_uart_ != nullptr)
-		{
-			debug_uart_->print(F("\nACK for setting max values: "));
-		}
-		#endif
-		if(latest_command_success_)
-		{
-			radar_uart_last_packet_ = millis();
-			#ifdef LD2410_DEBUG_COMMANDS
-			if(debug_uart_ != nullptr)
-			{
-				debug_uart_->print(F("OK"));
-			}
-			#endif
-			return true;
-		}
-		else
-		{
-			if(debug_uart_ != nullptr)
-			{
-				debug_uart_->print(F("failed"));
-			}
-			return false;
-		}
+		debug_uart_->print(F("\nACK for "));
+		debug_uart_->print((const __FlashStringHelper *)pgm_read_ptr(&ld2410_ack_table_[entry_].name));
+		debug_uart_->print(F(": "));
 	}
-	else if(intra_frame_data_length_ == 4 && latest_ack_ == 0x62)
+	statistics_.ackFrames++;
+	if(latest_command_success_ == false)
 	{
-		#ifdef LD2410_DEBUG_COMMANDS
-		if(debug_uart_ != nullptr)
-		{
-			debug_uart_->print(F("\nACK for engineering mode: "));
-		}
-		#endif
-		if(latest_command_success_)
+		statistics_.ackFailures++;
+		if(log_<LD2410_LOG_COMMANDS, LD2410_LOG_ERROR>())
 		{
-			radar_uart_last_packet_ = millis();
-			#ifdef LD2410_DEBUG_COMMANDS
-			if(debug_uart_ != nullptr)
-			{
-				debug_uart_->print(F("OK"));
-			}
-			#endif
-			return true;
-		}
-		else
-		{
-			if(debug_uart_ != nullptr)
-			{
-				debug_uart_->print(F("failed"));
-			}
-			return false;
+			debug_uart_->print(F("failed"));
 		}
+		return false;
 	}
-	else if(intra_frame_data_length_ == 4 && latest_ack_ == 0x63)
+	radar_uart_last_packet_ = millis();
+	if(log_<LD2410_LOG_COMMANDS, LD2410_LOG_INFO>())
 	{
-		#ifdef LD2410_DEBUG_COMMANDS
-		if(debug_uart_ != nullptr)
-		{
-			debug_uart_->print(F("\nACK for end engineering mode: "));
-		}
-		#endif
-		if(latest_command_success_)
-		{
-			radar_uart_last_packet_ = millis();
-			#ifdef LD2410_DEBUG_COMMANDS
-			if(debug_uart_ != nullptr)
-			{
-				debug_uart_->print(F("OK"));
-			}
-			#endif
-			return true;
-		}
-		else
-		{
-			if(debug_uart_ != nullptr)
-			{
-				debug_uart_->print(F("failed"));
-			}
-			return false;
-		}
+		debug_uart_->print(F("OK"));
 	}
-	else if(intra_frame_data_length_ == 28 && latest_ack_ == 0x61)
+	switch(pgm_read_byte(&ld2410_ack_table_[entry_].decoder))
 	{
-		#ifdef LD2410_DEBUG_COMMANDS
-		if(debug_uart_ != nullptr)
-		{
-			debug_uart_->print(F("\nACK for current configuration: "));
-		}
-		#endif
-		if(latest_command_success_)
-		{
-			radar_uart_last_packet_ = millis();
-			#ifdef LD2410_DEBUG_COMMANDS
-			if(debug_uart_ != nullptr)
+		case LD2410_ACK_DECODE_CONFIGURATION:
+			if(decode_configuration_ack_(ack_))
 			{
-				debug_uart_->print(F("OK"));
+				info_fetched_ |= LD2410_INFO_CONFIGURATION;
 			}
-			#endif
-			max_gate = radar_data_frame_[11];
-			max_moving_gate = radar_data_frame_[12];
-			max_stationary_gate = radar_data_frame_[13];
-			motion_sensitivity[0] = radar_data_frame_[14];
-			motion_sensitivity[1] = radar_data_frame_[15];
-			motion_sensitivity[2] = radar_data_frame_[16];
-			motion_sensitivity[3] = radar_data_frame_[17];
-			motion_sensitivity[4] = radar_data_frame_[18];
-			motion_sensitivity[5] = radar_data_frame_[19];
-			motion_sensitivity[6] = radar_data_frame_[20];
-			motion_sensitivity[7] = radar_data_frame_[21];
-			motion_sensitivity[8] = radar_data_frame_[22];
-			stationary_sensitivity[0] = radar_data_frame_[23];
-			stationary_sensitivity[1] = radar_data_frame_[24];
-			stationary_sensitivity[2] = radar_data_frame_[25];
-			stationary_sensitivity[3] = radar_data_frame_[26];
-			stationary_sensitivity[4] = radar_data_frame_[27];
-			stationary_sensitivity[5] = radar_data_frame_[28];
-			stationary_sensitivity[6] = radar_data_frame_[29];
-			stationary_sensitivity[7] = radar_data_frame_[30];
-			stationary_sensitivity[8] = radar_data_frame_[31];
-			sensor_idle_time = radar_data_frame_[32];
-			sensor_idle_time += (radar_data_frame_[33] << 8);
-			#ifdef LD2410_DEBUG_COMMANDS
-			if(debug_uart_ != nullptr)
+			break;
+		case LD2410_ACK_DECODE_FIRMWARE_VERSION:
 			{
-				debug_uart_->print(F("\nMax gate distance: "));
-				debug_uart_->print(max_gate);
-				debug_uart_->print(F("\nMax motion detecting gate distance: "));
-				debug_uart_->print(max_moving_gate);
-				debug_uart_->print(F("\nMax stationary detecting gate distance: "));
-				debug_uart_->print(max_stationary_gate);
-				debug_uart_->print(F("\nSensitivity per gate"));
-				for(uint8_t i = 0; i < 9; i++)
+				ld2410FirmwareVersion version_;
+				if(ld2410Codec::decodeFirmwareVersion(ack_, version_))
 				{
-					debug_uart_->print(F("\nGate "));
-					debug_uart_->print(i);
-					debug_uart_->print(F(" ("));
-					debug_uart_->print(i * 0.75);
-					debug_uart_->print('-');
-					debug_uart_->print((i+1) * 0.75);
-					debug_uart_->print(F(" metres) Motion: "));
-					debug_uart_->print(motion_sensitivity[i]);
-					debug_uart_->print(F(" Stationary: "));
-					debug_uart_->print(stationary_sensitivity[i]);
+					firmware_major_version = version_.major;
+					firmware_minor_version = version_.minor;
+					firmware_bugfix_version = version_.bugfix;
+					info_fetched_ |= LD2410_INFO_FIRMWARE;
 				}
-				debug_uart_->print(F("\nSensor idle timeout: "));
-				debug_uart_->print(sensor_idle_time);
-				debug_uart_->print('s');
 			}
-			#endif
-			return true;
-		}
-		else
-		{
-			if(debug_uart_ != nullptr)
+			break;
+		case LD2410_ACK_DECODE_RESOLUTION:
 			{
-				debug_uart_->print(F("failed"));
+				uint8_t resolution_;
+				if(ld2410Codec::decodeResolution(ack_, resolution_))
+				{
+					if((info_fetched_ & LD2410_INFO_RESOLUTION) == 0 || resolution != resolution_)	//Reading back what is already saved doesn't need saving
+					{
+						configuration_changed_ = true;
+					}
+					resolution = resolution_;
+					info_fetched_ |= LD2410_INFO_RESOLUTION;
+				}
 			}
-			return false;
-		}
-	}
-	else if(intra_frame_data_length_ == 4 && latest_ack_ == 0x64)
-	{
-		#ifdef LD2410_DEBUG_COMMANDS
-		if(debug_uart_ != nullptr)
-		{
-			debug_uart_->print(F("\nACK for setting sensitivity values: "));
-		}
-		#endif
-		if(latest_command_success_)
-		{
-			radar_uart_last_packet_ = millis();
-			#ifdef LD2410_DEBUG_COMMANDS
-			if(debug_uart_ != nullptr)
+			break;
+		case LD2410_ACK_DECODE_MAC:
+			if(ld2410Codec::decodeMac(ack_, mac) == false)
 			{
-				debug_uart_->print(F("OK"));
+				break;
 			}
-			#endif
-			return true;
-		}
-		else
-		{
-			if(debug_uart_ != nullptr)
+			info_fetched_ |= LD2410_INFO_MAC;
+			if(log_<LD2410_LOG_COMMANDS, LD2410_LOG_INFO>())
 			{
-				debug_uart_->print(F("failed"));
+				debug_uart_->print(F("\nMAC Address: "));
+				for(uint8_t i = 0; i < 6; i++)
+				{
+					debug_uart_->print(mac[i], HEX);
+				}
+				debug_uart_->print(F("\n"));
 			}
-			return false;
-		}
+			break;
+		case LD2410_ACK_DECODE_ENGINEERING_STARTED:
+			is_Engineering_mode_ = true;
+			break;
+		case LD2410_ACK_DECODE_ENGINEERING_ENDED:
+			is_Engineering_mode_ = false;
+			break;
 	}
-	else if(intra_frame_data_length_ == 12 && latest_ack_ == 0xA0)
+	return true;
+}
+
+bool ld2410::decode_configuration_ack_(const ld2410Ack &ack_)
+{
+	ld2410Configuration configuration_;
+	if(ld2410Codec::decodeConfiguration(ack_, configuration_) == false)
 	{
-		#ifdef LD2410_DEBUG_COMMANDS
-		if(debug_uart_ != nullptr)
-		{
-			debug_uart_->print(F("\nACK for firmware version: "));
-		}
-		#endif
-		if(latest_command_success_)
-		{
-			firmware_major_version = radar_data_frame_[13];
-			firmware_minor_version = radar_data_frame_[12];
-			firmware_bugfix_version = radar_data_frame_[14];
-			firmware_bugfix_version += radar_data_frame_[15]<<8;
-			firmware_bugfix_version += radar_data_frame_[16]<<16;
-			firmware_bugfix_version += radar_data_frame_[17]<<24;
-			radar_uart_last_packet_ = millis();
-			#ifdef LD2410_DEBUG_COMMANDS
-			if(debug_uart_ != nullptr)
-			{
-				debug_uart_->print(F("OK"));
-			}
-			#endif
-			return true;
-		}
-		else
-		{
-			if(debug_uart_ != nullptr)
-			{
-				debug_uart_->print(F("failed"));
-			}
-			return false;
-		}
+		return false;
 	}
-	else if(intra_frame_data_length_ == 4 && latest_ack_ == 0xA2)
+	if(	(info_fetched_ & LD2410_INFO_CONFIGURATION) == 0 ||	//Only save it if something differs, every read back would otherwise wear out flash
+		max_gate != configuration_.maxGate ||
+		max_moving_gate != configuration_.maxMovingGate ||
+		max_stationary_gate != configuration_.maxStationaryGate ||
+		sensor_idle_time != configuration_.idleTime ||
+		memcmp(motion_sensitivity, configuration_.motionSensitivity, LD2410_GATES) != 0 ||
+		memcmp(stationary_sensitivity, configuration_.stationarySensitivity, LD2410_GATES) != 0
+	)
 	{
-		#ifdef LD2410_DEBUG_COMMANDS
-		if(debug_uart_ != nullptr)
-		{
-			debug_uart_->print(F("\nACK for factory reset: "));
-		}
-		#endif
-		if(latest_command_success_)
-		{
-			radar_uart_last_packet_ = millis();
-			#ifdef LD2410_DEBUG_COMMANDS
-			if(debug_uart_ != nullptr)
-			{
-				debug_uart_->print(F("OK"));
-			}
-			#endif
-			return true;
-		}
-		else
+		configuration_changed_ = true;
+	}
+	max_gate = configuration_.maxGate;
+	max_moving_gate = configuration_.maxMovingGate;
+	max_stationary_gate = configuration_.maxStationaryGate;
+	memcpy(motion_sensitivity, configuration_.motionSensitivity, LD2410_GATES);
+	memcpy(stationary_sensitivity, configuration_.stationarySensitivity, LD2410_GATES);
+	sensor_idle_time = configuration_.idleTime;
+	if(log_<LD2410_LOG_COMMANDS, LD2410_LOG_INFO>())
+	{
+		debug_uart_->print(F("\nMax gate distance: "));
+		debug_uart_->print(max_gate);
+		debug_uart_->print(F("\nMax motion detecting gate distance: "));
+		debug_uart_->print(max_moving_gate);
+		debug_uart_->print(F("\nMax stationary detecting gate distance: "));
+		debug_uart_->print(max_stationary_gate);
+		debug_uart_->print(F("\nSensitivity per gate"));
+		for(uint8_t i = 0; i < 9; i++)
+		{
+			debug_uart_->print(F("\nGate "));
+			debug_uart_->print(i);
+			debug_uart_->print(F(" ("));
+			debug_uart_->print(i * 0.75);
+			debug_uart_->print('-');
+			debug_uart_->print((i+1) * 0.75);
+			debug_uart_->print(F(" metres) Motion: "));
+			debug_uart_->print(motion_sensitivity[i]);
+			debug_uart_->print(F(" Stationary: "));
+			debug_uart_->print(stationary_sensitivity[i]);
+		}
+		debug_uart_->print(F("\nSensor idle timeout: "));
+		debug_uart_->print(sensor_idle_time);
+		debug_uart_->print('s');
+	}
+	return true;
+}
+
+void ld2410::send_command_(uint8_t command, uint16_t value0, uint16_t value1, uint16_t value2)
+{
+	uint8_t frame_[LD2410_MAX_COMMAND_LENGTH];
+	uint8_t length_;
+	if(command == LD2410_CMD_ENTER_CONFIGURATION)	//Sent around every command, so built at compile time
+	{
+		typedef ld2410ValueCommandFrame<LD2410_CMD_ENTER_CONFIGURATION, 0x0001> enter_;
+		ld2410Codec::copyFrame(frame_, enter_::frame, enter_::length);
+		length_ = enter_::length;
+	}
+	else if(command == LD2410_CMD_LEAVE_CONFIGURATION)
+	{
+		typedef ld2410CommandFrame<LD2410_CMD_LEAVE_CONFIGURATION> leave_;
+		ld2410Codec::copyFrame(frame_, leave_::frame, leave_::length);
+		length_ = leave_::length;
+	}
+	else
+	{
+		length_ = ld2410Codec::encodeCommand(frame_, command, value0, value1, value2);
+	}
+	radar_uart_->write(frame_, length_);	//One write, so the UART driver can send it as a block
+}
+
+bool ld2410::enter_configuration_mode_()
+{
+	send_command_(LD2410_CMD_ENTER_CONFIGURATION);
+	return wait_for_ack_(LD2410_CMD_ENTER_CONFIGURATION, LD2410_LATENCY_ENTER);
+}
+
+bool ld2410::leave_configuration_mode_()
+{
+	send_command_(LD2410_CMD_LEAVE_CONFIGURATION);
+	return wait_for_ack_(LD2410_CMD_LEAVE_CONFIGURATION, LD2410_LATENCY_LEAVE);
+}
+
+bool ld2410::wait_for_ack_(uint8_t command, uint8_t kind)
+{
+	ack_received_ = false;
+	radar_uart_last_command_ = millis();
+	while(millis() - radar_uart_last_command_ < commandTimeout(kind))
+	{
+		read_frame_();
+		if(ack_received_)
 		{
-			if(debug_uart_ != nullptr)
+			ack_received_ = false;
+			if(latest_ack_ == command)	//Paced by the ACK rather than a fixed delay
 			{
-				debug_uart_->print(F("failed"));
+				record_latency_(kind, millis() - radar_uart_last_command_);
+				return latest_command_success_;
 			}
-			return false;
 		}
 	}
-	else if(intra_frame_data_length_ == 4 && latest_ack_ == 0xA3)
+	record_timeout_(kind);
+	return false;
+}
+
+bool ld2410::run_command_(uint8_t command, uint16_t value0, uint16_t value1, uint16_t value2)
+{
+	if(command_phase_ != LD2410_PHASE_IDLE)	//Don't interleave with a non-blocking command
 	{
-		#ifdef LD2410_DEBUG_COMMANDS
-		if(debug_uart_ != nullptr)
-		{
-			debug_uart_->print(F("\nACK for restart: "));
-		}
-		#endif
-		if(latest_command_success_)
+		return false;
+	}
+	if(configuration_matches_(command, value0, value1, value2))	//The sensor already has this setting
+	{
+		return true;
+	}
+	bool success_ = false;
+	if(enter_configuration_mode_())
+	{
+		send_command_(command, value0, value1, value2);
+		success_ = wait_for_ack_(command, LD2410_LATENCY_COMMAND);
+	}
+	if(success_ && leave_not_acked_(command))	//Sent anyway, but waiting would only time out
+	{
+		send_command_(LD2410_CMD_LEAVE_CONFIGURATION);
+	}
+	else
+	{
+		leave_configuration_mode_();
+	}
+	if(success_)
+	{
+		configuration_set_(command, value0, value1, value2);
+	}
+	save_configuration_();
+	return success_;
+}
+
+bool ld2410::submitCommand(uint8_t command, uint16_t value0, uint16_t value1, uint16_t value2, ld2410CommandCallback callback, void *context)
+{
+	if(beginTransaction() == false)	//Busy, or the application has a transaction open
+	{
+		return false;
+	}
+	if(queueCommand(command, value0, value1, value2) == false)
+	{
+		cancelTransaction();
+		return false;
+	}
+	return commitTransaction(false, callback, context);
+}
+
+uint8_t ld2410::commandStatus()
+{
+	return command_status_;
+}
+
+bool ld2410::commandInProgress()
+{
+	return command_phase_ != LD2410_PHASE_IDLE;
+}
+
+void ld2410::releaseCommandCallback(void *context)
+{
+	if(command_callback_context_ == context)	//Left alone if another command has registered its own since
+	{
+		command_callback_ = nullptr;
+		command_callback_context_ = nullptr;
+	}
+}
+
+bool ld2410::beginTransaction()
+{
+	if(command_phase_ != LD2410_PHASE_IDLE || transaction_open_)	//Never throw away a queue someone is still building
+	{
+		return false;
+	}
+	queue_length_ = 0;
+	transaction_open_ = true;
+	return true;
+}
+
+bool ld2410::transactionOpen()
+{
+	return transaction_open_;
+}
+
+void ld2410::cancelTransaction()
+{
+	if(transaction_open_)
+	{
+		queue_length_ = 0;
+		transaction_open_ = false;
+	}
+}
+
+bool ld2410::queueCommand(uint8_t command, uint16_t value0, uint16_t value1, uint16_t value2)
+{
+	if(transaction_open_ == false || queue_length_ == LD2410_MAX_QUEUED_COMMANDS)
+	{
+		return false;
+	}
+	command_queue_[queue_length_].command = command;
+	command_queue_[queue_length_].status = LD2410_COMMAND_IDLE;
+	command_queue_[queue_length_].value[0] = value0;
+	command_queue_[queue_length_].value[1] = value1;
+	command_queue_[queue_length_].value[2] = value2;
+	queue_length_++;
+	return true;
+}
+
+bool ld2410::queueMaxValues(uint16_t moving, uint16_t stationary, uint16_t inactivityTimer)
+{
+	return queueCommand(LD2410_CMD_SET_MAX_VALUES, moving, stationary, inactivityTimer);
+}
+
+bool ld2410::queueGateSensitivityThreshold(uint8_t gate, uint8_t moving, uint8_t stationary)
+{
+	return queueCommand(LD2410_CMD_SET_GATE_SENSITIVITY, gate, moving, stationary);
+}
+
+bool ld2410::queueResolution(uint8_t res)
+{
+	return queueCommand(LD2410_CMD_SET_RESOLUTION, res);
+}
+
+bool ld2410::queueBluetooth(bool enabled)
+{
+	return queueCommand(LD2410_CMD_SET_BLUETOOTH, enabled ? 1 : 0);
+}
+
+bool ld2410::commitTransaction(bool wait, ld2410CommandCallback callback, void *context)
+{
+	if(transaction_open_ == false)
+	{
+		return false;
+	}
+	transaction_open_ = false;	//Closed whether or not it can be sent
+	if(radar_uart_ == nullptr || queue_length_ == 0)
+	{
+		return false;
+	}
+	bool needed_ = false;
+	for(uint8_t i = 0; i < queue_length_; i++)
+	{
+		ld2410QueuedCommand &queued_ = command_queue_[i];
+		if(configuration_matches_(queued_.command, queued_.value[0], queued_.value[1], queued_.value[2]))	//Skipped when sending
 		{
-			radar_uart_last_packet_ = millis();
-			#ifdef LD2410_DEBUG_COMMANDS
-			if(debug_uart_ != nullptr)
-			{
-				debug_uart_->print(F("OK"));
-			}
-			#endif
-			return true;
+			queued_.status = LD2410_COMMAND_SUCCEEDED;
 		}
 		else
 		{
-			if(debug_uart_ != nullptr)
-			{
-				debug_uart_->print(F("failed"));
-			}
-			return false;
+			queued_.status = LD2410_COMMAND_PENDING;
+			needed_ = true;
 		}
-	}	
-    else if(intra_frame_data_length_ == 6 && latest_ack_ == 0xAB)
+	}
+	queue_sent_ = 0;
+	queue_acked_ = 0;
+	command_callback_ = callback;
+	command_callback_context_ = context;
+	command_status_ = LD2410_COMMAND_PENDING;
+	if(needed_ == false)	//Nothing to change, don't take the sensor out of reporting mode
 	{
-		#ifdef LD2410_DEBUG_COMMANDS
-		if(debug_uart_ != nullptr)
+		finish_command_();
+		return wait == false || command_status_ == LD2410_COMMAND_SUCCEEDED;
+	}
+	send_command_(LD2410_CMD_ENTER_CONFIGURATION);
+	command_phase_ = LD2410_PHASE_ENTERING;
+	radar_uart_last_command_ = millis();
+	if(wait == false)
+	{
+		return true;
+	}
+	while(command_phase_ != LD2410_PHASE_IDLE)
+	{
+		readAvailable();
+	}
+	return command_status_ == LD2410_COMMAND_SUCCEEDED;
+}
+
+uint8_t ld2410::transactionLength()
+{
+	return queue_length_;
+}
+
+uint8_t ld2410::transactionResult(uint8_t index)
+{
+	if(index < queue_length_)
+	{
+		return command_queue_[index].status;
+	}
+	return LD2410_COMMAND_IDLE;
+}
+
+void ld2410::send_queued_commands_()
+{
+	while(true)
+	{
+		while(queue_acked_ < queue_sent_ && command_queue_[queue_acked_].status != LD2410_COMMAND_PENDING)	//Step over commands the known configuration made unnecessary
 		{
-			debug_uart_->print(F("\nACK for read distance resolution: "));
+			queue_acked_++;
 		}
-		#endif
-		if(latest_command_success_)
+		if(queue_sent_ == queue_length_ || queue_sent_ - queue_acked_ >= LD2410_PIPELINE_DEPTH)
 		{
-			resolution = radar_data_frame_[10];
-			radar_uart_last_packet_ = millis();
-			#ifdef LD2410_DEBUG_COMMANDS
-			if(debug_uart_ != nullptr)
-			{
-				debug_uart_->print(F("OK"));
-			}
-			#endif
-			return true;
+			break;
 		}
-		else
+		ld2410QueuedCommand &queued_ = command_queue_[queue_sent_++];
+		if(queued_.status == LD2410_COMMAND_PENDING)
 		{
-			if(debug_uart_ != nullptr)
-			{
-				debug_uart_->print(F("failed"));
-			}
-			return false;
+			send_command_(queued_.command, queued_.value[0], queued_.value[1], queued_.value[2]);
 		}
 	}
-	else if(intra_frame_data_length_ == 4 && latest_ack_ == 0xAA)
+	if(queue_acked_ == queue_length_)
 	{
-		#ifdef LD2410_DEBUG_COMMANDS
-		if(debug_uart_ != nullptr)
-		{
-			debug_uart_->print(F("\nACK for set distance resolution: "));
-		}
-		#endif
-		if(latest_command_success_)
+		start_leaving_configuration_mode_();
+	}
+	else
+	{
+		radar_uart_last_command_ = millis();
+	}
+}
+
+void ld2410::complete_queued_command_(uint8_t status)
+{
+	ld2410QueuedCommand &queued_ = command_queue_[queue_acked_++];
+	if(queued_.status != LD2410_COMMAND_PENDING)	//Skipped because the sensor already had the setting
+	{
+		return;
+	}
+	queued_.status = status;
+	if(status == LD2410_COMMAND_SUCCEEDED)
+	{
+		configuration_set_(queued_.command, queued_.value[0], queued_.value[1], queued_.value[2]);
+	}
+	else if(status == LD2410_COMMAND_TIMED_OUT)	//The sensor may or may not have applied it
+	{
+		forget_configuration_();
+	}
+}
+
+void ld2410::command_ack_received_(uint8_t command, bool success)
+{
+	if(command_phase_ == LD2410_PHASE_ENTERING && command == LD2410_CMD_ENTER_CONFIGURATION)
+	{
+		record_latency_(LD2410_LATENCY_ENTER, millis() - radar_uart_last_command_);
+		if(success)
 		{
-			radar_uart_last_packet_ = millis();
-			#ifdef LD2410_DEBUG_COMMANDS
-			if(debug_uart_ != nullptr)
-			{
-				debug_uart_->print(F("OK"));
-			}
-			#endif
-			return true;
+			command_phase_ = LD2410_PHASE_WAITING;
+			send_queued_commands_();
 		}
 		else
 		{
-			if(debug_uart_ != nullptr)
+			for(uint8_t i = 0; i < queue_length_; i++)
 			{
-				debug_uart_->print(F("failed"));
+				if(command_queue_[i].status == LD2410_COMMAND_PENDING)
+				{
+					command_queue_[i].status = LD2410_COMMAND_FAILED;
+				}
 			}
-			return false;
+			start_leaving_configuration_mode_();
 		}
 	}
-	else if(intra_frame_data_length_ == 4 && latest_ack_ == 0xA4)
+	else if(command_phase_ == LD2410_PHASE_WAITING)
 	{
-		#ifdef LD2410_DEBUG_COMMANDS
-		if(debug_uart_ != nullptr)
-		{
-			debug_uart_->print(F("\nACK for set Bluetooth: "));
-		}
-		#endif
-		if(latest_command_success_)
+		uint8_t acknowledged_ = queue_acked_;	//ACKs come back in the order commands were sent, so one for a later command means those before it were lost
+		while(acknowledged_ < queue_sent_ && (command_queue_[acknowledged_].status != LD2410_COMMAND_PENDING || command_queue_[acknowledged_].command != command))
 		{
-			radar_uart_last_packet_ = millis();
-			#ifdef LD2410_DEBUG_COMMANDS
-			if(debug_uart_ != nullptr)
-			{
-				debug_uart_->print(F("OK"));
-			}
-			#endif
-			return true;
+			acknowledged_++;
 		}
-		else
+		if(acknowledged_ < queue_sent_)
 		{
-			if(debug_uart_ != nullptr)
+			record_latency_(LD2410_LATENCY_COMMAND, millis() - radar_uart_last_command_);
+			while(queue_acked_ < acknowledged_)
 			{
-				debug_uart_->print(F("failed"));
+				if(command_queue_[queue_acked_].status == LD2410_COMMAND_PENDING)
+				{
+					statistics_.commandTimeouts++;
+				}
+				complete_queued_command_(LD2410_COMMAND_TIMED_OUT);
 			}
-			return false;
+			complete_queued_command_(success ? LD2410_COMMAND_SUCCEEDED : LD2410_COMMAND_FAILED);
+			send_queued_commands_();
 		}
 	}
-	else if(intra_frame_data_length_ == 10 && latest_ack_ == 0xA5)
+	else if(command_phase_ == LD2410_PHASE_LEAVING && command == LD2410_CMD_LEAVE_CONFIGURATION)
 	{
-		#ifdef LD2410_DEBUG_COMMANDS
-		if(debug_uart_ != nullptr)
+		record_latency_(LD2410_LATENCY_LEAVE, millis() - radar_uart_last_command_);
+		finish_command_();
+	}
+}
+
+void ld2410::check_command_timeout_()
+{
+	if(command_phase_ != LD2410_PHASE_IDLE && millis() - radar_uart_last_command_ >= commandTimeout(latency_kind_()))
+	{
+		record_timeout_(latency_kind_());
+		if(command_phase_ == LD2410_PHASE_LEAVING)	//The results are already known, carry on regardless
 		{
-			debug_uart_->print(F("\nACK for get MAC: "));
+			finish_command_();
 		}
-		#endif
-		if(latest_command_success_)
+		else if(command_phase_ == LD2410_PHASE_WAITING)	//Give up on the oldest command in flight but try the rest
 		{
-			radar_uart_last_packet_ = millis();
-			#ifdef LD2410_DEBUG_COMMANDS
-			if(debug_uart_ != nullptr)
-			{
-				debug_uart_->print(F("OK"));
-			}
-			#endif
-
-			mac[0] = radar_data_frame_[10];
-			mac[1] = radar_data_frame_[11];
-			mac[2] = radar_data_frame_[12];
-			mac[3] = radar_data_frame_[13];
-			mac[4] = radar_data_frame_[14];
-			mac[5] = radar_data_frame_[15];
-
-			#ifdef LD2410_DEBUG_COMMANDS
-			if(debug_uart_ != nullptr)
-			{
-				debug_uart_->print(F("\nMAC Address: "));
-				debug_uart_->print(mac[0], HEX);
-				debug_uart_->print(mac[1], HEX);
-				debug_uart_->print(mac[2], HEX);
-				debug_uart_->print(mac[3], HEX);
-				debug_uart_->print(mac[4], HEX);
-				debug_uart_->print(mac[5], HEX);
-				debug_uart_->print(F("\n"));
-			}
-			#endif
-
-			return true;
+			complete_queued_command_(LD2410_COMMAND_TIMED_OUT);
+			send_queued_commands_();
 		}
 		else
 		{
-			if(debug_uart_ != nullptr)
+			for(uint8_t i = 0; i < queue_length_; i++)
 			{
-				debug_uart_->print(F("failed"));
+				if(command_queue_[i].status == LD2410_COMMAND_PENDING)
+				{
+					command_queue_[i].status = LD2410_COMMAND_TIMED_OUT;
+				}
 			}
-			return false;
+			start_leaving_configuration_mode_();
 		}
 	}
-	else
+}
+
+uint8_t ld2410::latency_kind_()
+{
+	if(command_phase_ == LD2410_PHASE_ENTERING)
 	{
-		#ifdef LD2410_DEBUG_COMMANDS
-		if(debug_uart_ != nullptr)
+		return LD2410_LATENCY_ENTER;
+	}
+	if(command_phase_ == LD2410_PHASE_LEAVING)
+	{
+		return LD2410_LATENCY_LEAVE;
+	}
+	return LD2410_LATENCY_COMMAND;
+}
+
+void ld2410::record_latency_(uint8_t kind, uint32_t latency)
+{
+	#if LD2410_LATENCY_HISTOGRAM
+	uint8_t bucket_ = 0;
+	while(latency > 0 && bucket_ < LD2410_LATENCY_BUCKETS - 1)	//Position of the top bit, so buckets double in width
+	{
+		latency >>= 1;
+		bucket_++;
+	}
+	if(latency_samples_[kind] == 0xFFFF)	//Halve everything rather than overflow, keeping the shape
+	{
+		latency_samples_[kind] = 0;
+		for(uint8_t i = 0; i < LD2410_LATENCY_BUCKETS; i++)
 		{
-			debug_uart_->print(F("\nUnknown ACK"));
+			latency_histogram_[kind][i] >>= 1;
+			latency_samples_[kind] += latency_histogram_[kind][i];
 		}
-		#endif
 	}
-	return false;
+	latency_histogram_[kind][bucket_]++;
+	latency_samples_[kind]++;
+	if(latency_samples_[kind] >= LD2410_LATENCY_MIN_SAMPLES)
+	{
+		uint32_t timeout_ = 2 * (uint32_t)latencyPercentile(kind, LD2410_LATENCY_PERCENTILE);
+		command_timeout_[kind] = timeout_ < LD2410_MIN_COMMAND_TIMEOUT ? LD2410_MIN_COMMAND_TIMEOUT : timeout_ > LD2410_MAX_COMMAND_TIMEOUT ? LD2410_MAX_COMMAND_TIMEOUT : timeout_;
+	}
+	#endif
 }
 
-void ld2410::send_command_preamble_()
+void ld2410::record_timeout_(uint8_t kind)
 {
-	//Command preamble
-	radar_uart_->write((byte)0xFD);
-	radar_uart_->write((byte)0xFC);
-	radar_uart_->write((byte)0xFB);
-	radar_uart_->write((byte)0xFA);
+	statistics_.commandTimeouts++;
+	#if LD2410_LATENCY_HISTOGRAM
+	if(latency_timeouts_[kind] < 0xFFFF)	//Kept out of the histogram, which would otherwise measure the timeout itself
+	{
+		latency_timeouts_[kind]++;
+	}
+	uint32_t timeout_ = 2 * (uint32_t)command_timeout_[kind];	//Back off, the next ACK received adapts it from the histogram again
+	command_timeout_[kind] = timeout_ > LD2410_MAX_COMMAND_TIMEOUT ? LD2410_MAX_COMMAND_TIMEOUT : timeout_;
+	#endif
 }
 
-void ld2410::send_command_postamble_()
+uint16_t ld2410::latencyHistogram(uint8_t kind, uint8_t bucket)
 {
-	//Command end
-	radar_uart_->write((byte)0x04);
-	radar_uart_->write((byte)0x03);
-	radar_uart_->write((byte)0x02);
-	radar_uart_->write((byte)0x01);
+	#if LD2410_LATENCY_HISTOGRAM
+	if(kind < LD2410_LATENCY_KINDS && bucket < LD2410_LATENCY_BUCKETS)
+	{
+		return latency_histogram_[kind][bucket];
+	}
+	#endif
+	return 0;
 }
 
-bool ld2410::enter_configuration_mode_(bool wait)
+uint16_t ld2410::latencyPercentile(uint8_t kind, uint8_t percentile)
 {
-	send_command_preamble_();
-	//Request firmware
-	radar_uart_->write((byte) 0x04);	//Command is four bytes long
-	radar_uart_->write((byte) 0x00);
-	radar_uart_->write((byte) 0xFF);	//Request enter command mode
-	radar_uart_->write((byte) 0x00);
-	radar_uart_->write((byte) 0x01);
-	radar_uart_->write((byte) 0x00);
-	send_command_postamble_();
-
-	if (!wait) {
-		delay(50);
-		return true;
+	#if LD2410_LATENCY_HISTOGRAM
+	if(kind >= LD2410_LATENCY_KINDS || latency_samples_[kind] == 0)
+	{
+		return 0;
 	}
-
-	radar_uart_last_command_ = millis();
-	while(millis() - radar_uart_last_command_ < radar_uart_command_timeout_)
+	uint32_t target_ = ((uint32_t)latency_samples_[kind] * percentile + 99) / 100;	//Rank of the percentile, rounded up
+	uint32_t seen_ = 0;
+	for(uint8_t i = 0; i < LD2410_LATENCY_BUCKETS - 1; i++)
 	{
-		if(read_frame_())
+		seen_ += latency_histogram_[kind][i];
+		if(seen_ >= target_)
 		{
-			if(latest_ack_ == 0xFF && latest_command_success_)
-			{
-				return true;
-			}
+			return 1 << i;
 		}
 	}
-	return false;
+	return LD2410_MAX_COMMAND_TIMEOUT;	//The last bucket has no upper bound
+	#else
+	return 0;
+	#endif
 }
 
-bool ld2410::leave_configuration_mode_(bool wait)
+uint16_t ld2410::latencyTimeouts(uint8_t kind)
 {
-	send_command_preamble_();
-	//Request firmware
-	radar_uart_->write((byte) 0x02);	//Command is two bytes long
-	radar_uart_->write((byte) 0x00);
-	radar_uart_->write((byte) 0xFE);	//Request leave command mode
-	radar_uart_->write((byte) 0x00);
-	send_command_postamble_();
-	
-	if (!wait) {
-		delay(50);
-		return true;
+	#if LD2410_LATENCY_HISTOGRAM
+	if(kind < LD2410_LATENCY_KINDS)
+	{
+		return latency_timeouts_[kind];
 	}
+	#endif
+	return 0;
+}
 
-	radar_uart_last_command_ = millis();
-	while(millis() - radar_uart_last_command_ < radar_uart_command_timeout_)
+uint16_t ld2410::commandTimeout(uint8_t kind)
+{
+	if(kind >= LD2410_LATENCY_KINDS)
 	{
-		if(read_frame_())
-		{
-			if(latest_ack_ == 0xFE && latest_command_success_)
-			{
-				return true;
-			}
-		}
+		return 0;
 	}
-	return false;
+	#if LD2410_LATENCY_HISTOGRAM
+	return command_timeout_[kind];
+	#else
+	return radar_uart_command_timeout_;
+	#endif
 }
 
-bool ld2410::requestStartEngineeringMode()
+void ld2410::resetLatency()
 {
-	if(enter_configuration_mode_(false))
+	#if LD2410_LATENCY_HISTOGRAM
+	memset(latency_histogram_, 0, sizeof(latency_histogram_));
+	for(uint8_t i = 0; i < LD2410_LATENCY_KINDS; i++)
 	{
-		delay(50);
-		send_command_preamble_();
-		//Request firmware
-		radar_uart_->write((byte) 0x02);	//Command is two bytes long
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write((byte) 0x62);	//Request enter command mode
-		radar_uart_->write((byte) 0x00);
-		send_command_postamble_();
-		radar_uart_last_command_ = millis();
-		while(millis() - radar_uart_last_command_ < radar_uart_command_timeout_)
-		{
-			if(read_frame_())
-			{
-				if(latest_ack_ == 0x62 && latest_command_success_)
-				{
-					delay(50);
-					leave_configuration_mode_(false);
-					is_Engineering_mode_ = true;
-					return true;
-				}
-			}
-		}
+		latency_samples_[i] = 0;
+		latency_timeouts_[i] = 0;
+		command_timeout_[i] = radar_uart_command_timeout_;
 	}
-	delay(50);
-	leave_configuration_mode_(false);
-	return false;
+	#endif
 }
 
-bool ld2410::requestEndEngineeringMode()
+void ld2410::start_leaving_configuration_mode_()
 {
-	if(enter_configuration_mode_(false))
+	send_command_(LD2410_CMD_LEAVE_CONFIGURATION);
+	for(uint8_t i = 0; i < queue_length_; i++)
 	{
-		delay(50);
-		send_command_preamble_();
-		//Request firmware
-		radar_uart_->write((byte) 0x02);	//Command is two bytes long
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write((byte) 0x63);	//Request leave command mode
-		radar_uart_->write((byte) 0x00);
-		send_command_postamble_();
-		radar_uart_last_command_ = millis();
-		while(millis() - radar_uart_last_command_ < radar_uart_command_timeout_)
+		if(command_queue_[i].status == LD2410_COMMAND_SUCCEEDED && leave_not_acked_(command_queue_[i].command))	//It won't ACK leaving
 		{
-			if(read_frame_())
-			{
-				if(latest_ack_ == 0x63 && latest_command_success_)
-				{
-					delay(50);
-					leave_configuration_mode_(false);
-					is_Engineering_mode_ = false;
-					return true;
-				}
-			}
+			finish_command_();
+			return;
 		}
 	}
-	delay(50);
-	leave_configuration_mode_(false);
-	return false;
+	command_phase_ = LD2410_PHASE_LEAVING;
+	radar_uart_last_command_ = millis();
+}
+
+bool ld2410::leave_not_acked_(uint8_t command)
+{
+	return command == LD2410_CMD_RESTART || command == LD2410_CMD_FACTORY_RESET;
+}
+
+void ld2410::finish_command_()
+{
+	command_phase_ = LD2410_PHASE_IDLE;
+	save_configuration_();
+	command_status_ = LD2410_COMMAND_SUCCEEDED;
+	for(uint8_t i = 0; i < queue_length_ && command_status_ == LD2410_COMMAND_SUCCEEDED; i++)	//Report the first problem, if any
+	{
+		command_status_ = command_queue_[i].status;
+	}
+	ld2410CommandCallback callback_ = command_callback_;	//The last call may start another command, which replaces these
+	void *context_ = command_callback_context_;
+	uint8_t length_ = queue_length_;
+	for(uint8_t i = 0; i < length_ && callback_ != nullptr; i++)
+	{
+		callback_(command_queue_[i].command, command_queue_[i].status, context_);
+	}
+}
+
+bool ld2410::requestStartEngineeringMode()
+{
+	return run_command_(LD2410_CMD_START_ENGINEERING_MODE);
+}
+
+bool ld2410::requestEndEngineeringMode()
+{
+	return run_command_(LD2410_CMD_END_ENGINEERING_MODE);
 }
 
 bool ld2410::isEngineeringMode()
@@ -1156,383 +1469,231 @@ bool ld2410::isEngineeringMode()
 
 bool ld2410::requestCurrentConfiguration()
 {
-	if(enter_configuration_mode_(false))
-	{
-		delay(50);
-		send_command_preamble_();
-		//Request firmware
-		radar_uart_->write((byte) 0x02);	//Command is two bytes long
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write((byte) 0x61);	//Request current configuration
-		radar_uart_->write((byte) 0x00);
-		send_command_postamble_();
-		radar_uart_last_command_ = millis();
-		while(millis() - radar_uart_last_command_ < radar_uart_command_timeout_)
-		{
-			if(read_frame_())
-			{
-				if(latest_ack_ == 0x61 && latest_command_success_)
-				{
-					delay(50);
-					leave_configuration_mode_(false);
-					return true;
-				}
-			}
-		}
-	}
-	delay(50);
-	leave_configuration_mode_(false);
-	return false;
+	return run_command_(LD2410_CMD_READ_CONFIGURATION);
 }
 
 bool ld2410::requestFirmwareVersion()
 {
-	if(enter_configuration_mode_(false))
-	{
-		delay(50);
-		send_command_preamble_();
-		//Request firmware
-		radar_uart_->write((byte) 0x02);	//Command is two bytes long
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write((byte) 0xA0);	//Request firmware version
-		radar_uart_->write((byte) 0x00);
-		send_command_postamble_();
-		radar_uart_last_command_ = millis();
-		while(millis() - radar_uart_last_command_ < radar_uart_command_timeout_)
-		{
-			read_frame_();
-			if(latest_ack_ == 0xA0 && latest_command_success_)
-			{
-				delay(50);
-				leave_configuration_mode_(false);
-				return true;
-			}
-		}
-	}
-	delay(50);
-	leave_configuration_mode_(false);
-	return false;
+	return run_command_(LD2410_CMD_READ_FIRMWARE_VERSION);
 }
 
 bool ld2410::requestRestart()
 {
-	if(enter_configuration_mode_(false))
-	{
-		delay(50);
-		send_command_preamble_();
-		//Request firmware
-		radar_uart_->write((byte) 0x02);	//Command is two bytes long
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write((byte) 0xA3);	//Request restart
-		radar_uart_->write((byte) 0x00);
-		send_command_postamble_();
-		radar_uart_last_command_ = millis();
-		while(millis() - radar_uart_last_command_ < radar_uart_command_timeout_)
-		{
-			if(read_frame_())
-			{
-				if(latest_ack_ == 0xA3 && latest_command_success_)
-				{
-					delay(50);
-					leave_configuration_mode_(false);
-					return true;
-				}
-			}
-		}
-	}
-	delay(50);
-	leave_configuration_mode_(false);
-	return false;
+	return run_command_(LD2410_CMD_RESTART);
 }
 
 bool ld2410::requestFactoryReset()
 {
-	if(enter_configuration_mode_(false))
+	return run_command_(LD2410_CMD_FACTORY_RESET);
+}
+
+bool ld2410::requestResolution()
+{
+	return run_command_(LD2410_CMD_READ_RESOLUTION);
+}
+
+bool ld2410::setResolution(uint8_t res)
+{
+	return run_command_(LD2410_CMD_SET_RESOLUTION, res);
+}
+
+bool ld2410::enableBluetooth()
+{
+	return run_command_(LD2410_CMD_SET_BLUETOOTH, 1);
+}
+
+bool ld2410::disableBluetooth()
+{
+	return run_command_(LD2410_CMD_SET_BLUETOOTH, 0);
+}
+
+bool ld2410::getMAC()
+{
+	return run_command_(LD2410_CMD_GET_MAC);
+}
+
+bool ld2410::setBaudRate(uint32_t baudRate)
+{
+	for(uint8_t i = 0; i < LD2410_BAUD_RATES; i++)
 	{
-		delay(50);
-		send_command_preamble_();
-		//Request firmware
-		radar_uart_->write((byte) 0x02);	//Command is two bytes long
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write((byte) 0xA2);	//Request factory reset
-		radar_uart_->write((byte) 0x00);
-		send_command_postamble_();
-		radar_uart_last_command_ = millis();
-		while(millis() - radar_uart_last_command_ < radar_uart_command_timeout_)
+		if(pgm_read_dword(&ld2410_baud_rates_[i]) == baudRate)
 		{
-			if(read_frame_())
-			{
-				if(latest_ack_ == 0xA2 && latest_command_success_)
-				{
-					delay(50);
-					leave_configuration_mode_(false);
-					return true;
-				}
-			}
+			return run_command_(LD2410_CMD_SET_BAUD_RATE, i + 1);
 		}
 	}
-	delay(50);
-	leave_configuration_mode_(false);
 	return false;
 }
 
-bool ld2410::requestResolution()
+uint32_t ld2410::detectBaudRate(ld2410BaudCallback baudCallback, void *context, uint16_t listen)
 {
-	if(enter_configuration_mode_(false))
+	baud_rate_ = 0;
+	if(radar_uart_ == nullptr || baudCallback == nullptr)
 	{
-		delay(50);
-		send_command_preamble_();
-		//Request distance resolution
-		radar_uart_->write((byte) 0x02);	//Command is two bytes long
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write((byte) 0xAB);	//Request distance resolution setting
-		radar_uart_->write((byte) 0x00);
-		send_command_postamble_();
-		radar_uart_last_command_ = millis();
-		while(millis() - radar_uart_last_command_ < radar_uart_command_timeout_)
+		return 0;
+	}
+	for(uint8_t i = 0; i < LD2410_BAUD_RATES; i++)
+	{
+		uint32_t rate_ = pgm_read_dword(&ld2410_baud_rates_[pgm_read_byte(&ld2410_baud_search_order_[i])]);
+		baudCallback(rate_, context);
+		for(int stale_ = radar_uart_->available(); stale_ > 0; stale_--)	//Anything buffered was received at the previous rate, parse it but don't look for the header in it
+		{
+			input_byte_(radar_uart_->read());
+		}
+		uint32_t header_ = 0;	//The last four bytes, the sensor streams data frames so a header turns up quickly at the right rate
+		uint32_t started_ = millis();
+		while(millis() - started_ < listen)
 		{
-			if(read_frame_())
+			if(radar_uart_->available())
 			{
-				if(latest_ack_ == 0xAB && latest_command_success_)
+				uint8_t byte_read_ = radar_uart_->read();
+				input_byte_(byte_read_);	//Counted, captured and parsed as read() would, so this frame isn't lost
+				header_ = (header_ << 8) | byte_read_;
+				if(header_ == 0xF4F3F2F1)
 				{
-					delay(50);
-					leave_configuration_mode_(false);
-					return true;
+					if(debug_uart_ != nullptr)
+					{
+						debug_uart_->print(F("\nLD2410 baud rate: "));
+						debug_uart_->println(rate_);
+					}
+					baud_rate_ = rate_;
+					return rate_;
 				}
 			}
 		}
 	}
-	delay(50);
-	leave_configuration_mode_(false);
-	return false;
+	return 0;
 }
 
-bool ld2410::setResolution(uint8_t res)
+bool ld2410::setStorage(ld2410Storage *storage, const char *key)
 {
-	if(enter_configuration_mode_(false))
+	storage_ = storage;
+	storage_key_ = key;
+	uint8_t saved_[LD2410_CACHE_LENGTH];
+	if(storage_ == nullptr || storage_->load(storage_key_, saved_, sizeof(saved_)) == false || saved_[0] != LD2410_CACHE_VERSION)
 	{
-		delay(50);
-		send_command_preamble_();
-		radar_uart_->write((byte) 0x04);	
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write((byte) 0xAA);
-		radar_uart_->write((byte) 0x00);
-
-		radar_uart_->write(char(res));
-		radar_uart_->write((byte) 0x00);
-		send_command_postamble_();
-		radar_uart_last_command_ = millis();
-		while(millis() - radar_uart_last_command_ < radar_uart_command_timeout_)
-		{
-			if(read_frame_())
-			{
-				if(latest_ack_ == 0xAA && latest_command_success_)
-				{
-					delay(50);
-					leave_configuration_mode_(false);
-					return true;
-				}
-			}
-		}
+		return false;
 	}
-	delay(50);
-	leave_configuration_mode_(false);
+	info_fetched_ = (info_fetched_ & ~LD2410_CACHE_FLAGS) | (saved_[1] & LD2410_CACHE_FLAGS);
+	max_gate = saved_[2];
+	max_moving_gate = saved_[3];
+	max_stationary_gate = saved_[4];
+	sensor_idle_time = saved_[5] + (saved_[6] << 8);
+	memcpy(motion_sensitivity, &saved_[7], 9);
+	memcpy(stationary_sensitivity, &saved_[16], 9);
+	resolution = saved_[25];
+	bluetooth_enabled_ = saved_[26];
+	return true;
+}
 
-	return false;
+void ld2410::invalidateConfiguration()
+{
+	forget_configuration_();
+	save_configuration_();
 }
 
-bool ld2410::enableBluetooth()
+void ld2410::forget_configuration_()
 {
-	if(enter_configuration_mode_(false))
-	{
-		delay(50);
-		send_command_preamble_();
-		radar_uart_->write((byte) 0x04);	
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write((byte) 0xA4);
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write((byte) 0x01);
-		radar_uart_->write((byte) 0x00);
-		send_command_postamble_();
-		radar_uart_last_command_ = millis();
-		while(millis() - radar_uart_last_command_ < radar_uart_command_timeout_)
-		{
-			if(read_frame_())
-			{
-				if(latest_ack_ == 0xA4 && latest_command_success_)
-				{
-					delay(50);
-					leave_configuration_mode_(false);
-					return true;
-				}
-			}
-		}
+	if(info_fetched_ & LD2410_CACHE_FLAGS)	//Nothing to save if nothing was known
+	{
+		configuration_changed_ = true;
 	}
-	delay(50);
-	leave_configuration_mode_(false);
+	info_fetched_ &= ~LD2410_CACHE_FLAGS;
+	info_attempted_ &= ~LD2410_CACHE_FLAGS;
+}
 
+bool ld2410::configuration_matches_(uint8_t command, uint16_t value0, uint16_t value1, uint16_t value2)
+{
+	switch(command)
+	{
+		case LD2410_CMD_SET_MAX_VALUES:
+			return (info_fetched_ & LD2410_INFO_CONFIGURATION) && max_moving_gate == value0 && max_stationary_gate == value1 && sensor_idle_time == value2;
+		case LD2410_CMD_SET_GATE_SENSITIVITY:
+			return (info_fetched_ & LD2410_INFO_CONFIGURATION) && value0 < 9 && motion_sensitivity[value0] == value1 && stationary_sensitivity[value0] == value2;
+		case LD2410_CMD_SET_RESOLUTION:
+			return (info_fetched_ & LD2410_INFO_RESOLUTION) && resolution == value0;
+		case LD2410_CMD_SET_BLUETOOTH:
+			return (info_fetched_ & LD2410_CACHE_BLUETOOTH) && bluetooth_enabled_ == (value0 != 0);
+	}
 	return false;
 }
 
-bool ld2410::disableBluetooth()
+void ld2410::configuration_set_(uint8_t command, uint16_t value0, uint16_t value1, uint16_t value2)
 {
-	if(enter_configuration_mode_(false))
-	{
-		delay(50);
-		send_command_preamble_();
-		radar_uart_->write((byte) 0x04);	
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write((byte) 0xA4);
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write((byte) 0x00);
-		send_command_postamble_();
-		radar_uart_last_command_ = millis();
-		while(millis() - radar_uart_last_command_ < radar_uart_command_timeout_)
-		{
-			if(read_frame_())
+	switch(command)
+	{
+		case LD2410_CMD_SET_MAX_VALUES:
+			max_moving_gate = value0;
+			max_stationary_gate = value1;
+			sensor_idle_time = value2;
+			break;
+		case LD2410_CMD_SET_GATE_SENSITIVITY:
+			if(value0 >= 9)	//0xFFFF sets every gate
 			{
-				if(latest_ack_ == 0xA4 && latest_command_success_)
+				for(uint8_t i = 0; i < 9; i++)
 				{
-					delay(50);
-					leave_configuration_mode_(false);
-					return true;
+					motion_sensitivity[i] = value1;
+					stationary_sensitivity[i] = value2;
 				}
 			}
-		}
+			else
+			{
+				motion_sensitivity[value0] = value1;
+				stationary_sensitivity[value0] = value2;
+			}
+			break;
+		case LD2410_CMD_SET_RESOLUTION:
+			resolution = value0;
+			info_fetched_ |= LD2410_INFO_RESOLUTION;
+			break;
+		case LD2410_CMD_SET_BLUETOOTH:
+			bluetooth_enabled_ = value0 != 0;
+			info_fetched_ |= LD2410_CACHE_BLUETOOTH;
+			break;
+		case LD2410_CMD_FACTORY_RESET:	//Back to defaults we don't know
+			forget_configuration_();
+			return;
+		default:
+			return;
 	}
-	delay(50);
-	leave_configuration_mode_(false);
-
-	return false;
+	configuration_changed_ = true;
 }
 
-bool ld2410::getMAC()
+void ld2410::save_configuration_()
 {
-	if(enter_configuration_mode_(false))
-	{
-		delay(50);
-		send_command_preamble_();
-		radar_uart_->write((byte) 0x04);	
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write((byte) 0xA5);
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write((byte) 0x01);
-		radar_uart_->write((byte) 0x00);
-		send_command_postamble_();
-		radar_uart_last_command_ = millis();
-		while(millis() - radar_uart_last_command_ < radar_uart_command_timeout_)
-		{
-			if(read_frame_())
-			{
-				if(latest_ack_ == 0xA5 && latest_command_success_)
-				{
-					delay(50);
-					leave_configuration_mode_(false);
-					return true;
-				}
-			}
-		}
+	if(configuration_changed_ == false || storage_ == nullptr)
+	{
+		return;
+	}
+	uint8_t saved_[LD2410_CACHE_LENGTH];
+	saved_[0] = LD2410_CACHE_VERSION;
+	saved_[1] = info_fetched_ & LD2410_CACHE_FLAGS;
+	saved_[2] = max_gate;
+	saved_[3] = max_moving_gate;
+	saved_[4] = max_stationary_gate;
+	saved_[5] = sensor_idle_time & 0xFF;
+	saved_[6] = sensor_idle_time >> 8;
+	memcpy(&saved_[7], motion_sensitivity, 9);
+	memcpy(&saved_[16], stationary_sensitivity, 9);
+	saved_[25] = resolution;
+	saved_[26] = bluetooth_enabled_;
+	if(storage_->save(storage_key_, saved_, sizeof(saved_)))
+	{
+		configuration_changed_ = false;
 	}
-	delay(50);
-	leave_configuration_mode_(false);
+}
 
-	return false;
+uint32_t ld2410::baudRate()
+{
+	return baud_rate_;
 }
 
 bool ld2410::setMaxValues(uint16_t moving, uint16_t stationary, uint16_t inactivityTimer)
 {
-	if(enter_configuration_mode_(false))
-	{
-		delay(50);
-		send_command_preamble_();
-		radar_uart_->write((byte) 0x14);	//Command is 20 bytes long
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write((byte) 0x60);	//Request set max values
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write((byte) 0x00);	//Moving gate command
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write(char(moving & 0x00FF));	//Moving gate value
-		radar_uart_->write(char((moving & 0xFF00)>>8));
-		radar_uart_->write((byte) 0x00);	//Spacer
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write((byte) 0x01);	//Stationary gate command
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write(char(stationary & 0x00FF));	//Stationary gate value
-		radar_uart_->write(char((stationary & 0xFF00)>>8));
-		radar_uart_->write((byte) 0x00);	//Spacer
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write((byte) 0x02);	//Inactivity timer command
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write(char(inactivityTimer & 0x00FF));	//Inactivity timer
-		radar_uart_->write(char((inactivityTimer & 0xFF00)>>8));
-		radar_uart_->write((byte) 0x00);	//Spacer
-		radar_uart_->write((byte) 0x00);
-		send_command_postamble_();
-		radar_uart_last_command_ = millis();
-		while(millis() - radar_uart_last_command_ < radar_uart_command_timeout_)
-		{
-			if(read_frame_())
-			{
-				if(latest_ack_ == 0x60 && latest_command_success_)
-				{
-					delay(50);
-					leave_configuration_mode_(false);
-					return true;
-				}
-			}
-		}
-	}
-	delay(50);
-	leave_configuration_mode_(false);
-	return false;
+	return run_command_(LD2410_CMD_SET_MAX_VALUES, moving, stationary, inactivityTimer);
 }
 
 bool ld2410::setGateSensitivityThreshold(uint8_t gate, uint8_t moving, uint8_t stationary)
 {
-	if(enter_configuration_mode_(false))
-	{
-		delay(50);
-		send_command_preamble_();
-		radar_uart_->write((byte) 0x14);	//Command is 20 bytes long
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write((byte) 0x64);	//Request set sensitivity values
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write((byte) 0x00);	//Gate command
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write(char(gate));	//Gate value
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write((byte) 0x00);	//Spacer
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write((byte) 0x01);	//Motion sensitivity command
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write(char(moving));	//Motion sensitivity value
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write((byte) 0x00);	//Spacer
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write((byte) 0x02);	//Stationary sensitivity command
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write(char(stationary));	//Stationary sensitivity value
-		radar_uart_->write((byte) 0x00);
-		radar_uart_->write((byte) 0x00);	//Spacer
-		radar_uart_->write((byte) 0x00);
-		send_command_postamble_();
-		radar_uart_last_command_ = millis();
-		while(millis() - radar_uart_last_command_ < radar_uart_command_timeout_)
-		{
-			if(read_frame_())
-			{
-				if(latest_ack_ == 0x64 && latest_command_success_)
-				{
-					delay(50);
-					leave_configuration_mode_(false);
-					return true;
-				}
-			}
-		}
-	}
-	delay(50);
-	leave_configuration_mode_(false);
-	return false;
+	return run_command_(LD2410_CMD_SET_GATE_SENSITIVITY, gate, moving, stationary);
 }
 #endif
@@ -12,22 +12,200 @@
  */
 #ifndef ld2410_h
 #define ld2410_h
+#if defined(ARDUINO)
 #include <Arduino.h>
+#else
+#include "ld2410Port.h"
+#endif
+#include "ld2410Codec.h"
+
+#define LD2410_MOVING 0													//Which energy, for the per-gate classes
+#define LD2410_STATIONARY 1
+#ifndef LD2410_RING_BUFFER_LENGTH
+	#define LD2410_RING_BUFFER_LENGTH 64									//Must be a power of two, no more than 128 and at least LD2410_MAX_FRAME_LENGTH
+#endif
+#ifndef LD2410_READ_CHUNK_LENGTH
+	#define LD2410_READ_CHUNK_LENGTH 32										//Bytes pulled from the UART per readBytes() call when draining
+#endif
+
+#define LD2410_LOG_NONE 0												//Logging levels, chosen per category at compile time
+#define LD2410_LOG_ERROR 1
+#define LD2410_LOG_INFO 2
+#define LD2410_LOG_VERBOSE 3
 
-#define LD2410_MAX_FRAME_LENGTH 46
-//#define LD2410_DEBUG_DATA
-#define LD2410_DEBUG_COMMANDS
+#define LD2410_LOG_DATA 0												//Logging categories
+#define LD2410_LOG_COMMANDS 1
+#define LD2410_LOG_PARSE 2
+
+//#define LD2410_DEBUG_DATA												//Older switches, still honoured
+//#define LD2410_DEBUG_COMMANDS
 //#define LD2410_DEBUG_PARSE
 
+#ifndef LD2410_LOG_LEVEL_DATA											//Data frames and resynchronisation, VERBOSE prints every frame
+	#ifdef LD2410_DEBUG_DATA
+		#define LD2410_LOG_LEVEL_DATA LD2410_LOG_VERBOSE
+	#else
+		#define LD2410_LOG_LEVEL_DATA LD2410_LOG_ERROR
+	#endif
+#endif
+#ifndef LD2410_LOG_LEVEL_COMMANDS										//Commands and ACKs, INFO prints each one
+	#ifdef LD2410_DEBUG_COMMANDS
+		#define LD2410_LOG_LEVEL_COMMANDS LD2410_LOG_INFO
+	#else
+		#define LD2410_LOG_LEVEL_COMMANDS LD2410_LOG_ERROR
+	#endif
+#endif
+#ifndef LD2410_LOG_LEVEL_PARSE											//Decoded target data
+	#ifdef LD2410_DEBUG_PARSE
+		#define LD2410_LOG_LEVEL_PARSE LD2410_LOG_INFO
+	#else
+		#define LD2410_LOG_LEVEL_PARSE LD2410_LOG_NONE
+	#endif
+#endif
+
+#ifndef LD2410_MAX_QUEUED_COMMANDS
+	#define LD2410_MAX_QUEUED_COMMANDS 12								//Enough for a full profile, 9 gates plus max values, resolution and Bluetooth
+#endif
+#if LD2410_MAX_QUEUED_COMMANDS < 1 || LD2410_MAX_QUEUED_COMMANDS > 255
+#error LD2410_MAX_QUEUED_COMMANDS must be between 1 and 255
+#endif
+#ifndef LD2410_PIPELINE_DEPTH
+	#define LD2410_PIPELINE_DEPTH 1										//Commands in flight at once in a transaction, 1 waits for each ACK before sending the next
+#endif
+#if LD2410_PIPELINE_DEPTH < 1
+#error LD2410_PIPELINE_DEPTH must be at least 1
+#endif
+
+#ifndef LD2410_LATENCY_HISTOGRAM
+	#define LD2410_LATENCY_HISTOGRAM 1									//0 leaves out the round trip histogram and uses a fixed ACK timeout
+#endif
+#define LD2410_LATENCY_ENTER 0											//Command round trips measured separately
+#define LD2410_LATENCY_COMMAND 1
+#define LD2410_LATENCY_LEAVE 2
+#define LD2410_LATENCY_KINDS 3
+#define LD2410_LATENCY_BUCKETS 10										//Bucket 0 is under 1ms, bucket n 2^(n-1) to 2^n ms and the last everything slower
+#define LD2410_LATENCY_MIN_SAMPLES 8										//Round trips measured before the timeout adapts
+#define LD2410_LATENCY_PERCENTILE 99										//Percentile of round trips the timeout allows twice for
+#ifndef LD2410_MIN_COMMAND_TIMEOUT
+	#define LD2410_MIN_COMMAND_TIMEOUT 50									//Adaptive ACK timeout limits (ms)
+#endif
+#ifndef LD2410_MAX_COMMAND_TIMEOUT
+	#define LD2410_MAX_COMMAND_TIMEOUT 1000
+#endif
+
+#define LD2410_DEFAULT_BAUD_RATE 256000									//As shipped
+#ifndef LD2410_AUTOBAUD_LISTEN
+	#define LD2410_AUTOBAUD_LISTEN 150										//How long to listen for a data header at each baud rate (ms)
+#endif
+
+#ifndef LD2410_PASSIVE_TIMEOUT
+	#define LD2410_PASSIVE_TIMEOUT 500										//How long beginPassive() waits for the first data frame (ms)
+#endif
+
+#define LD2410_INFO_FIRMWARE 0x01										//Sensor information fetched in the background, can be combined
+#define LD2410_INFO_MAC 0x02
+#define LD2410_INFO_CONFIGURATION 0x04
+#define LD2410_INFO_RESOLUTION 0x08
+
+#define LD2410_COMMAND_IDLE 0											//Status of a non-blocking command
+#define LD2410_COMMAND_PENDING 1
+#define LD2410_COMMAND_SUCCEEDED 2
+#define LD2410_COMMAND_FAILED 3
+#define LD2410_COMMAND_TIMED_OUT 4
+
+#if (LD2410_RING_BUFFER_LENGTH & (LD2410_RING_BUFFER_LENGTH - 1)) != 0 || LD2410_RING_BUFFER_LENGTH > 128 || LD2410_RING_BUFFER_LENGTH < LD2410_MAX_FRAME_LENGTH
+#error LD2410_RING_BUFFER_LENGTH must be a power of two between LD2410_MAX_FRAME_LENGTH and 128
+#endif
+
+template<uint8_t category> struct ld2410LogLevel;						//Compile time level of each category, disabled logging compiles to nothing
+template<> struct ld2410LogLevel<LD2410_LOG_DATA> { static const uint8_t value = LD2410_LOG_LEVEL_DATA; };
+template<> struct ld2410LogLevel<LD2410_LOG_COMMANDS> { static const uint8_t value = LD2410_LOG_LEVEL_COMMANDS; };
+template<> struct ld2410LogLevel<LD2410_LOG_PARSE> { static const uint8_t value = LD2410_LOG_LEVEL_PARSE; };
+
+struct ld2410QueuedCommand {											//A command waiting to be sent in a transaction
+	uint8_t command;
+	uint8_t status;
+	uint16_t value[3];
+};
+
+struct ld2410LinkStatistics {											//Counters for the health of the link to the sensor
+	uint32_t bytesIn;													//Bytes read from the UART
+	uint32_t dataFrames;												//Normal data frames parsed
+	uint32_t engineeringFrames;											//Engineering mode data frames parsed
+	uint32_t ackFrames;													//ACK frames parsed, including failures
+	uint32_t unknownFrames;												//Well formed frames of a type or length not understood
+	uint32_t bytesDiscarded;											//Bytes skipped while resynchronising
+	uint32_t overruns;													//Frames too long for the buffer
+	uint32_t lengthErrors;												//Frames where the footer wasn't where the length said
+	uint32_t ackFailures;												//ACKs reporting the command failed
+	uint32_t commandTimeouts;											//Commands that got no ACK in time
+	uint32_t lastGoodFrame;												//millis() of the last frame parsed successfully
+};
+
+class ld2410Storage;													//See ld2410Storage.h
+
+typedef void (*ld2410DataCallback)(const ld2410Reading &reading, void *context);	//Called once per decoded data frame
+typedef void (*ld2410AckCallback)(uint8_t command, bool success, void *context);	//Called once per ACK frame
+typedef void (*ld2410CommandCallback)(uint8_t command, uint8_t status, void *context);	//Called when a non-blocking command completes
+typedef void (*ld2410BaudCallback)(uint32_t baudRate, void *context);	//Called to restart the UART at a different baud rate
+typedef void (*ld2410InputCallback)(const uint8_t *data, uint16_t length, void *context);	//Called with raw bytes as they are read from the UART
+
 class ld2410	{
 
 	public:
 		ld2410();														//Constructor function
 		~ld2410();														//Destructor function
 		bool begin(Stream &, bool waitForRadar = true);					//Start the ld2410
+		bool begin(Stream &, ld2410BaudCallback baudCallback, void *context = nullptr, bool waitForRadar = true);	//Start the ld2410, detecting its baud rate first
+		bool beginPassive(Stream &, uint16_t timeout = LD2410_PASSIVE_TIMEOUT);	//Start the ld2410, connected once a data frame arrives, no commands sent
+		bool infoAvailable(uint8_t info);								//True if the LD2410_INFO_ values have been read, otherwise starts reading them in the background
+		bool setStorage(ld2410Storage *storage, const char *key = "ld2410");	//Keep the known configuration in storage, true if a saved one was loaded
+		void invalidateConfiguration();									//Forget the known configuration, eg. if it was changed elsewhere
 		void debug(Stream &);											//Start debugging on a stream
+		void setDataCallback(ld2410DataCallback callback, void *context = nullptr);	//Called with every decoded data frame, nullptr to stop
+		void setAckCallback(ld2410AckCallback callback, void *context = nullptr);	//Called with every ACK frame, nullptr to stop
+		void setInputCallback(ld2410InputCallback callback, void *context = nullptr);	//Called with the raw bytes before parsing, nullptr to stop
 		bool isConnected();
 		bool read();
+		uint16_t readAvailable(uint16_t *bytesPending = nullptr, uint16_t maxBytes = 0);	//Drain what is already buffered, up to maxBytes if not 0, returns the number of frames decoded
+		uint16_t feed(const uint8_t *data, size_t length);				//Parse bytes received some other way, eg. by a UART driver callback, returns the number of frames decoded. Never writes to the UART
+		template<class Transport> uint16_t readFrom(Transport &transport, uint16_t maxBytes = 0)	//As readAvailable() but from a concrete type, so its available() and read() can be inlined
+		{
+			uint16_t frames_decoded_ = 0;
+			uint16_t bytes_read_ = 0;
+			while(maxBytes == 0 || bytes_read_ < maxBytes)
+			{
+				int bytes_to_read_ = transport.available();
+				uint8_t space_ = LD2410_RING_BUFFER_LENGTH - (uint8_t)(ring_head_ - ring_tail_);	//Fill the ring directly, then parse once per fill
+				if(bytes_to_read_ > space_)
+				{
+					bytes_to_read_ = space_;
+				}
+				if(maxBytes > 0 && bytes_to_read_ > maxBytes - bytes_read_)
+				{
+					bytes_to_read_ = maxBytes - bytes_read_;
+				}
+				if(bytes_to_read_ <= 0)
+				{
+					break;
+				}
+				for(uint8_t i = 0; i < bytes_to_read_; i++)
+				{
+					radar_ring_buffer_[ring_head_++ & (LD2410_RING_BUFFER_LENGTH - 1)] = transport.read();
+				}
+				bytes_read_ += bytes_to_read_;
+				frames_decoded_ += ring_filled_(bytes_to_read_);
+			}
+			poll_command_();
+			return frames_decoded_;
+		}
+		ld2410LinkStatistics statistics();								//Link counters since starting or the last reset
+		void resetStatistics();
+		uint16_t latencyHistogram(uint8_t kind, uint8_t bucket);		//Round trips seen in a bucket, kind is LD2410_LATENCY_ENTER, _COMMAND or _LEAVE
+		uint16_t latencyPercentile(uint8_t kind, uint8_t percentile);	//Upper bound in ms of the bucket holding a percentile, 0 if nothing measured
+		uint16_t latencyTimeouts(uint8_t kind);							//Round trips that got no ACK in time, these aren't in the histogram
+		uint16_t commandTimeout(uint8_t kind);							//Current ACK timeout in ms, adapted from the histogram
+		void resetLatency();											//Forget the round trips, timeouts go back to the default
 		bool presenceDetected();
 		bool stationaryTargetDetected();
 		uint16_t stationaryTargetDistance();
@@ -62,22 +240,75 @@ class ld2410	{
 		bool enableBluetooth();                                         //Enable or Disable Bluetooth
 		bool disableBluetooth();
 		bool getMAC();
+		bool setBaudRate(uint32_t baudRate);							//Takes effect after requestRestart(), false if the rate isn't supported
+		uint32_t detectBaudRate(ld2410BaudCallback baudCallback, void *context = nullptr, uint16_t listen = LD2410_AUTOBAUD_LISTEN);	//Try each rate until data arrives, 0 if none worked
+		uint32_t baudRate();											//Detected baud rate, 0 if not known
 		uint8_t mac[6] = {0,0,0,0,0,0};
+		bool submitCommand(uint8_t command, uint16_t value0 = 0, uint16_t value1 = 0, uint16_t value2 = 0, ld2410CommandCallback callback = nullptr, void *context = nullptr);	//Start a command without blocking, read() moves it along
+		uint8_t commandStatus();										//Status of the last submitted command
+		bool commandInProgress();										//Is a non-blocking command still running
+		void releaseCommandCallback(void *context);						//Stop calling back with this context, eg. because it is being destroyed. The command carries on
+		bool beginTransaction();										//Start queueing commands to send in a single configuration session, false if a command or transaction is in progress
+		bool transactionOpen();											//Has a transaction been started but not yet committed or cancelled
+		void cancelTransaction();										//Throw away an uncommitted transaction
+		bool queueCommand(uint8_t command, uint16_t value0 = 0, uint16_t value1 = 0, uint16_t value2 = 0);
+		bool queueMaxValues(uint16_t moving, uint16_t stationary, uint16_t inactivityTimer);
+		bool queueGateSensitivityThreshold(uint8_t gate, uint8_t moving, uint8_t stationary);
+		bool queueResolution(uint8_t res);
+		bool queueBluetooth(bool enabled);
+		bool commitTransaction(bool wait = true, ld2410CommandCallback callback = nullptr, void *context = nullptr);	//Send the queue, blocking returns true if every command succeeded
+		uint8_t transactionLength();									//Number of commands in the transaction
+		uint8_t transactionResult(uint8_t index);						//Status of each command in the transaction
 	protected:
 	private:
 		Stream *radar_uart_ = nullptr;
+		uint32_t baud_rate_ = 0;										//Found by detectBaudRate()
+		uint8_t info_fetched_ = 0;										//LD2410_INFO_ values decoded from an ACK
+		uint8_t info_attempted_ = 0;									//LD2410_INFO_ values already asked for in the background
+		bool bluetooth_enabled_ = false;								//Last set, there's no command to read it
+		bool configuration_changed_ = false;							//The known configuration needs saving
+		ld2410Storage *storage_ = nullptr;
+		const char *storage_key_ = nullptr;
 		Stream *debug_uart_ = nullptr;									//The stream used for the debugging
 		uint32_t radar_uart_timeout = 250;								//How long to give up on receiving some useful data from the LD2410
 		uint32_t radar_uart_last_packet_ = 0;							//Time of the last packet from the radar
 		uint32_t radar_uart_last_command_ = 0;							//Time of the last command sent to the radar
 		uint32_t radar_uart_command_timeout_ = 250;						//Timeout for sending commands
 		uint8_t latest_ack_ = 0;
+		bool ack_received_ = false;										//Set on every ACK frame, for the blocking commands
+		#if LD2410_LATENCY_HISTOGRAM
+		uint16_t latency_histogram_[LD2410_LATENCY_KINDS][LD2410_LATENCY_BUCKETS] = {};	//Command round trip times
+		uint16_t latency_samples_[LD2410_LATENCY_KINDS] = {};
+		uint16_t latency_timeouts_[LD2410_LATENCY_KINDS] = {};			//Counted apart from the round trip times
+		uint16_t command_timeout_[LD2410_LATENCY_KINDS] = {250, 250, 250};	//Adapted ACK timeouts, starting from radar_uart_command_timeout_
+		#endif
 		bool latest_command_success_ = false;
-		uint8_t radar_data_frame_[LD2410_MAX_FRAME_LENGTH];				//Store the incoming data from the radar, to check it's in a valid format
-		uint8_t radar_data_frame_position_ = 0;							//Where in the frame we are currently writing
-		bool frame_started_ = false;									//Whether a frame is currently being read
-		bool ack_frame_ = false;										//Whether the incoming frame is LIKELY an ACK frame
+		uint8_t radar_ring_buffer_[LD2410_RING_BUFFER_LENGTH];			//Raw bytes from the radar, frames are assembled from here
+		uint8_t ring_head_ = 0;											//Free running index where the next byte is written
+		uint8_t ring_tail_ = 0;											//Free running index of the oldest byte not yet consumed
+		uint8_t radar_data_frame_[LD2410_MAX_FRAME_LENGTH];				//A complete frame copied out of the ring for parsing
+		uint8_t radar_data_frame_position_ = 0;							//Length of the frame being parsed
+		bool ack_frame_ = false;										//Whether the frame being parsed is an ACK frame
+		uint8_t command_phase_ = 0;										//Where the non-blocking command engine is up to
+		uint8_t command_status_ = LD2410_COMMAND_IDLE;					//Reported status of the last submitted command
+		ld2410DataCallback data_callback_ = nullptr;
+		void *data_callback_context_ = nullptr;
+		ld2410AckCallback ack_callback_ = nullptr;
+		void *ack_callback_context_ = nullptr;
+		ld2410LinkStatistics statistics_ = {};							//Always kept, a few increments per frame
+		ld2410InputCallback input_callback_ = nullptr;
+		void *input_callback_context_ = nullptr;
+		ld2410QueuedCommand command_queue_[LD2410_MAX_QUEUED_COMMANDS];	//Commands in the current transaction and their results
+		uint8_t queue_length_ = 0;										//Number of commands queued
+		bool transaction_open_ = false;									//Between beginTransaction() and commitTransaction()/cancelTransaction()
+		uint8_t queue_sent_ = 0;										//Number of commands sent so far
+		uint8_t queue_acked_ = 0;										//Number of commands with a result so far
+		ld2410CommandCallback command_callback_ = nullptr;				//Called when the non-blocking command completes
+		void *command_callback_context_ = nullptr;
 		bool waiting_for_ack_ = false;									//Whether a command has just been sent
+		uint8_t received_ack_command_[LD2410_PIPELINE_DEPTH + 1];		//ACKs parsed for the non-blocking engine and not yet acted on, no more than are in flight
+		bool received_ack_success_[LD2410_PIPELINE_DEPTH + 1];
+		uint8_t received_ack_count_ = 0;
 		uint8_t target_type_ = 0;
 		bool is_Engineering_mode_ = false;
 		uint16_t moving_target_distance_ = 0;
@@ -87,12 +318,40 @@ class ld2410	{
 		uint16_t detection_distance_ = 0;
 		
 		bool read_frame_();												//Try to read a frame from the UART
+		uint8_t input_byte_(uint8_t byte_read_);						//Count, pass to the input callback and parse a byte read from the UART
+		uint8_t process_byte_(uint8_t byte_read_);						//Add a byte to the ring, returns how many valid frames it completed
+		uint8_t ring_byte_(uint8_t offset);								//Byte at an offset from the ring tail
+		uint8_t assemble_frames_();										//Parse every complete frame in the ring, resynchronising on bad data
+		uint8_t ring_filled_(uint8_t added_);							//Account for bytes written straight into the ring, then parse them
+		void poll_command_();											//Advance the non-blocking command engine on the ACKs received and check for a timeout
 		bool parse_data_frame_();										//Is the current data frame valid?
+		void notify_data_(const ld2410Reading &reading_);				//Pass a decoded data frame to the callback
 		bool parse_command_frame_();									//Is the current command frame valid?
+		bool decode_configuration_ack_(const ld2410Ack &ack_);			//Copy the configuration out of a 0x61 ACK, to be saved if it differs
+		template<uint8_t category, uint8_t level> bool log_()			//Should this message be printed
+		{
+			return ld2410LogLevel<category>::value >= level && debug_uart_ != nullptr;
+		}
 		void print_frame_();											//Print the frame for debugging
-		void send_command_preamble_();									//Commands have the same preamble
-		void send_command_postamble_();									//Commands have the same postamble
-		bool enter_configuration_mode_(bool wait);								//Necessary before sending any command
-		bool leave_configuration_mode_(bool wait);								//Will not read values without leaving command mode
+		void print_padded_(uint8_t value);								//Print a value as three digits
+		void send_command_(uint8_t command, uint16_t value0 = 0, uint16_t value1 = 0, uint16_t value2 = 0);	//Encode and send any command
+		bool run_command_(uint8_t command, uint16_t value0 = 0, uint16_t value1 = 0, uint16_t value2 = 0);	//Send a command in configuration mode and block for the ACK
+		void command_ack_received_(uint8_t command, bool success);		//Advance the non-blocking commands on an ACK
+		void check_command_timeout_();									//Advance the non-blocking commands on a timeout
+		void send_queued_commands_();									//Send as many queued commands as the pipeline allows
+		void complete_queued_command_(uint8_t status);					//Record the result of the oldest command in flight
+		void start_leaving_configuration_mode_();
+		void finish_command_();
+		bool enter_configuration_mode_();								//Necessary before sending any command
+		bool leave_configuration_mode_();								//Will not read values without leaving command mode
+		bool wait_for_ack_(uint8_t command, uint8_t kind);				//Block until the ACK for a command or the adaptive timeout
+		uint8_t latency_kind_();										//Which round trip the non-blocking engine is waiting on
+		void record_latency_(uint8_t kind, uint32_t latency);			//Add a round trip to the histogram and adapt the timeout
+		void record_timeout_(uint8_t kind);								//Count a round trip with no ACK and back off the timeout
+		bool leave_not_acked_(uint8_t command);							//After restart and factory reset the sensor doesn't ACK leaving configuration mode
+		bool configuration_matches_(uint8_t command, uint16_t value0, uint16_t value1, uint16_t value2);	//Would this setting change nothing
+		void configuration_set_(uint8_t command, uint16_t value0, uint16_t value1, uint16_t value2);	//Update the known configuration after a setting succeeds
+		void forget_configuration_();									//The sensor may hold anything, send every setting until it is read again
+		void save_configuration_();										//Write the known configuration to storage if it changed
 };
 #endif
@@ -0,0 +1,205 @@
+/*
+ *	C++20 coroutine versions of the ld2410 configuration methods.
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#ifndef ld2410Async_cpp
+#define ld2410Async_cpp
+#include "ld2410Async.h"
+#ifdef LD2410_HAS_COROUTINES
+#include <exception>
+
+void ld2410Coroutine::promise_type::unhandled_exception()
+{
+	std::terminate();	//Nothing to report it to, and many Arduino builds have exceptions disabled
+}
+
+ld2410Coroutine::ld2410Coroutine(std::coroutine_handle<promise_type> handle) :
+	handle_(handle)
+{
+}
+
+ld2410Coroutine::ld2410Coroutine(ld2410Coroutine &&other) noexcept :
+	handle_(other.handle_)
+{
+	other.handle_ = nullptr;
+}
+
+ld2410Coroutine &ld2410Coroutine::operator=(ld2410Coroutine &&other) noexcept
+{
+	if(this != &other)
+	{
+		if(handle_)
+		{
+			handle_.destroy();
+		}
+		handle_ = other.handle_;
+		other.handle_ = nullptr;
+	}
+	return *this;
+}
+
+ld2410Coroutine::~ld2410Coroutine()	//Destructor function
+{
+	if(handle_)
+	{
+		handle_.destroy();
+	}
+}
+
+bool ld2410Coroutine::done()
+{
+	return handle_ == nullptr || handle_.done();
+}
+
+ld2410CommandAwaiter::ld2410CommandAwaiter(ld2410 &radar, uint8_t command, uint16_t value0, uint16_t value1, uint16_t value2) :
+	radar_(radar),
+	command_(command)
+{
+	value_[0] = value0;
+	value_[1] = value1;
+	value_[2] = value2;
+}
+
+ld2410CommandAwaiter::ld2410CommandAwaiter(ld2410 &radar) :
+	radar_(radar),
+	transaction_(true)
+{
+}
+
+ld2410CommandAwaiter::~ld2410CommandAwaiter()	//Destructor function
+{
+	radar_.releaseCommandCallback(this);	//Destroyed with its coroutine part way through, or finished and left registered
+}
+
+bool ld2410CommandAwaiter::await_suspend(std::coroutine_handle<> handle)
+{
+	handle_ = handle;
+	suspending_ = true;	//A command the sensor already has completes inside the submit, before there is anything to resume
+	bool submitted_;
+	if(transaction_)
+	{
+		results_expected_ = radar_.transactionLength();
+		submitted_ = radar_.commitTransaction(false, command_completed_, this);
+	}
+	else
+	{
+		submitted_ = radar_.submitCommand(command_, value_[0], value_[1], value_[2], command_completed_, this);
+	}
+	suspending_ = false;
+	if(submitted_ == false)
+	{
+		succeeded_ = false;
+		return false;
+	}
+	return completed_ == false;
+}
+
+bool ld2410CommandAwaiter::await_resume()
+{
+	return succeeded_;
+}
+
+void ld2410CommandAwaiter::command_completed_(uint8_t command, uint8_t status, void *context)
+{
+	(void)command;
+	ld2410CommandAwaiter *self_ = static_cast<ld2410CommandAwaiter *>(context);
+	if(status != LD2410_COMMAND_SUCCEEDED)
+	{
+		self_->succeeded_ = false;
+	}
+	if(++self_->results_ < self_->results_expected_)
+	{
+		return;
+	}
+	self_->completed_ = true;
+	if(self_->suspending_ == false)
+	{
+		self_->handle_.resume();	//The last thing the engine does with this command, so it is free to start the next
+	}
+}
+
+ld2410Async::ld2410Async(ld2410 &radar) :	//Constructor function
+	radar_(radar)
+{
+}
+
+ld2410CommandAwaiter ld2410Async::command(uint8_t command, uint16_t value0, uint16_t value1, uint16_t value2)
+{
+	return ld2410CommandAwaiter(radar_, command, value0, value1, value2);
+}
+
+ld2410CommandAwaiter ld2410Async::commitTransaction()
+{
+	return ld2410CommandAwaiter(radar_);
+}
+
+ld2410CommandAwaiter ld2410Async::requestFirmwareVersion()
+{
+	return command(LD2410_CMD_READ_FIRMWARE_VERSION);
+}
+
+ld2410CommandAwaiter ld2410Async::requestCurrentConfiguration()
+{
+	return command(LD2410_CMD_READ_CONFIGURATION);
+}
+
+ld2410CommandAwaiter ld2410Async::requestRestart()
+{
+	return command(LD2410_CMD_RESTART);
+}
+
+ld2410CommandAwaiter ld2410Async::requestFactoryReset()
+{
+	return command(LD2410_CMD_FACTORY_RESET);
+}
+
+ld2410CommandAwaiter ld2410Async::requestStartEngineeringMode()
+{
+	return command(LD2410_CMD_START_ENGINEERING_MODE);
+}
+
+ld2410CommandAwaiter ld2410Async::requestEndEngineeringMode()
+{
+	return command(LD2410_CMD_END_ENGINEERING_MODE);
+}
+
+ld2410CommandAwaiter ld2410Async::setMaxValues(uint16_t moving, uint16_t stationary, uint16_t inactivityTimer)
+{
+	return command(LD2410_CMD_SET_MAX_VALUES, moving, stationary, inactivityTimer);
+}
+
+ld2410CommandAwaiter ld2410Async::setGateSensitivityThreshold(uint8_t gate, uint8_t moving, uint8_t stationary)
+{
+	return command(LD2410_CMD_SET_GATE_SENSITIVITY, gate, moving, stationary);
+}
+
+ld2410CommandAwaiter ld2410Async::requestResolution()
+{
+	return command(LD2410_CMD_READ_RESOLUTION);
+}
+
+ld2410CommandAwaiter ld2410Async::setResolution(uint8_t res)
+{
+	return command(LD2410_CMD_SET_RESOLUTION, res);
+}
+
+ld2410CommandAwaiter ld2410Async::enableBluetooth()
+{
+	return command(LD2410_CMD_SET_BLUETOOTH, 1);
+}
+
+ld2410CommandAwaiter ld2410Async::disableBluetooth()
+{
+	return command(LD2410_CMD_SET_BLUETOOTH, 0);
+}
+
+ld2410CommandAwaiter ld2410Async::getMAC()
+{
+	return command(LD2410_CMD_GET_MAC);
+}
+#endif
+#endif
@@ -0,0 +1,104 @@
+/*
+ *	C++20 coroutine versions of the ld2410 configuration methods, so a configuration sequence can be written as straight-line code
+ *	that suspends at each command until its ACK arrives, instead of blocking or as a hand-written state machine.
+ *
+ *	Each method of ld2410Async returns an awaitable that submits the command with the non-blocking command engine and resumes the
+ *	coroutine, with true if it succeeded, once the engine finishes it. Calls to read() or readAvailable() move it along, as for
+ *	submitCommand(), so the sequences for several sensors interleave on one thread. Only one sequence can run per sensor at a time,
+ *	a command that can't be submitted because another is in progress resumes straight away with false. Coroutines are resumed from
+ *	inside read()/readAvailable(), so don't call the blocking ld2410 methods from them.
+ *
+ *	Coroutines return an ld2410Coroutine, which starts running as soon as it is called. Keep it until done(), as destroying it
+ *	destroys the suspended coroutine. A command it was waiting for carries on to the end, without resuming anything.
+ *
+ *	Needs C++20 and <coroutine>, so it is only available on newer toolchains, eg. recent ESP32 cores or Linux.
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#ifndef ld2410Async_h
+#define ld2410Async_h
+#include "ld2410.h"
+#if defined(__has_include)
+	#if __cplusplus >= 202002L && __has_include(<coroutine>)
+		#define LD2410_HAS_COROUTINES
+	#endif
+#endif
+#ifdef LD2410_HAS_COROUTINES
+#include <coroutine>
+
+class ld2410Coroutine	{												//Return type for coroutines that await ld2410Async commands
+
+	public:
+		struct promise_type	{
+			ld2410Coroutine get_return_object() { return ld2410Coroutine(std::coroutine_handle<promise_type>::from_promise(*this)); }
+			std::suspend_never initial_suspend() noexcept { return {}; }	//Run straight away, up to the first command
+			std::suspend_always final_suspend() noexcept { return {}; }	//Stay around so done() can be checked
+			void return_void() {}
+			void unhandled_exception();
+		};
+		ld2410Coroutine(ld2410Coroutine &&other) noexcept;
+		ld2410Coroutine &operator=(ld2410Coroutine &&other) noexcept;
+		ld2410Coroutine(const ld2410Coroutine &) = delete;
+		ld2410Coroutine &operator=(const ld2410Coroutine &) = delete;
+		~ld2410Coroutine();												//Destroys the coroutine, finished or not
+		bool done();													//Has the coroutine returned
+	protected:
+	private:
+		explicit ld2410Coroutine(std::coroutine_handle<promise_type> handle);
+		std::coroutine_handle<promise_type> handle_;
+};
+
+class ld2410CommandAwaiter	{											//Awaitable for one command or a whole transaction
+
+	public:
+		ld2410CommandAwaiter(ld2410 &radar, uint8_t command, uint16_t value0 = 0, uint16_t value1 = 0, uint16_t value2 = 0);	//A single command
+		explicit ld2410CommandAwaiter(ld2410 &radar);					//Commit the transaction already queued on the ld2410
+		ld2410CommandAwaiter(const ld2410CommandAwaiter &) = delete;	//The command engine holds a pointer to it
+		ld2410CommandAwaiter &operator=(const ld2410CommandAwaiter &) = delete;
+		~ld2410CommandAwaiter();										//Unregisters from the command engine, eg. when a waiting coroutine is destroyed
+		bool await_ready() { return false; }
+		bool await_suspend(std::coroutine_handle<> handle);				//Submit, false if it finished or failed to start without waiting
+		bool await_resume();											//True if the command, or every command in the transaction, succeeded
+	protected:
+	private:
+		ld2410 &radar_;
+		bool transaction_ = false;
+		uint8_t command_ = 0;
+		uint16_t value_[3] = {0, 0, 0};
+		std::coroutine_handle<> handle_;
+		uint8_t results_expected_ = 1;									//Callbacks before resuming, one per command
+		uint8_t results_ = 0;
+		bool succeeded_ = true;
+		bool suspending_ = false;										//Inside await_suspend(), where completion mustn't resume
+		bool completed_ = false;
+		static void command_completed_(uint8_t command, uint8_t status, void *context);	//Callback from the command engine
+};
+
+class ld2410Async	{
+
+	public:
+		ld2410Async(ld2410 &radar);										//Constructor function, the ld2410 must already be started with begin()
+		ld2410CommandAwaiter command(uint8_t command, uint16_t value0 = 0, uint16_t value1 = 0, uint16_t value2 = 0);	//Any command, as submitCommand()
+		ld2410CommandAwaiter commitTransaction();						//Send the commands queued with the ld2410's queue methods
+		ld2410CommandAwaiter requestFirmwareVersion();
+		ld2410CommandAwaiter requestCurrentConfiguration();
+		ld2410CommandAwaiter requestRestart();
+		ld2410CommandAwaiter requestFactoryReset();
+		ld2410CommandAwaiter requestStartEngineeringMode();
+		ld2410CommandAwaiter requestEndEngineeringMode();
+		ld2410CommandAwaiter setMaxValues(uint16_t moving, uint16_t stationary, uint16_t inactivityTimer);
+		ld2410CommandAwaiter setGateSensitivityThreshold(uint8_t gate, uint8_t moving, uint8_t stationary);
+		ld2410CommandAwaiter requestResolution();
+		ld2410CommandAwaiter setResolution(uint8_t res);
+		ld2410CommandAwaiter enableBluetooth();
+		ld2410CommandAwaiter disableBluetooth();
+		ld2410CommandAwaiter getMAC();
+	protected:
+	private:
+		ld2410 &radar_;
+};
+#endif
+#endif
@@ -0,0 +1,152 @@
+/*
+ *	Automatic empty-room calibration of the per-gate sensitivity thresholds.
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#ifndef ld2410Calibrator_cpp
+#define ld2410Calibrator_cpp
+#include "ld2410Calibrator.h"
+
+ld2410Calibrator::ld2410Calibrator(ld2410 &radar) :	//Constructor function
+	radar_(radar)
+{
+	memset(thresholds_, 0, sizeof(thresholds_));
+}
+
+ld2410Calibrator::~ld2410Calibrator()	//Destructor function
+{
+	stop_listening_();
+}
+
+bool ld2410Calibrator::begin(uint32_t duration, float quantile, uint8_t margin, bool apply)
+{
+	if(state_ == LD2410_CALIBRATION_STARTING || state_ == LD2410_CALIBRATION_COLLECTING || state_ == LD2410_CALIBRATION_APPLYING)
+	{
+		return false;
+	}
+	if(radar_.submitCommand(LD2410_CMD_START_ENGINEERING_MODE) == false)
+	{
+		return false;
+	}
+	for(uint8_t i = 0; i < 2 * LD2410_GATES; i++)
+	{
+		estimators_[i].reset(quantile);
+	}
+	duration_ = duration;
+	margin_ = margin;
+	apply_ = apply;
+	state_ = LD2410_CALIBRATION_STARTING;
+	return true;
+}
+
+uint8_t ld2410Calibrator::update()
+{
+	if(state_ == LD2410_CALIBRATION_STARTING && radar_.commandInProgress() == false)
+	{
+		if(radar_.commandStatus() == LD2410_COMMAND_SUCCEEDED)
+		{
+			radar_.setDataCallback(frame_decoded_, this);
+			listening_ = true;
+			started_ = millis();
+			state_ = LD2410_CALIBRATION_COLLECTING;
+		}
+		else
+		{
+			state_ = LD2410_CALIBRATION_FAILED;
+		}
+	}
+	else if(state_ == LD2410_CALIBRATION_COLLECTING && millis() - started_ >= duration_)
+	{
+		stop_listening_();
+		finish_collecting_();	//Stays collecting, with no more frames added, until the sensor is free
+	}
+	else if(state_ == LD2410_CALIBRATION_APPLYING && radar_.commandInProgress() == false)
+	{
+		state_ = radar_.commandStatus() == LD2410_COMMAND_SUCCEEDED ? LD2410_CALIBRATION_DONE : LD2410_CALIBRATION_FAILED;
+	}
+	return state_;
+}
+
+uint8_t ld2410Calibrator::state()
+{
+	return state_;
+}
+
+void ld2410Calibrator::frame_decoded_(const ld2410Reading &reading, void *context)
+{
+	if(reading.engineeringData)
+	{
+		ld2410Calibrator *self_ = static_cast<ld2410Calibrator *>(context);
+		for(uint8_t gate = 0; gate < LD2410_GATES; gate++)
+		{
+			self_->estimators_[gate].add(reading.movingGateEnergy[gate]);
+			self_->estimators_[LD2410_GATES + gate].add(reading.stationaryGateEnergy[gate]);
+		}
+	}
+}
+
+void ld2410Calibrator::stop_listening_()
+{
+	if(listening_)
+	{
+		radar_.setDataCallback(nullptr);
+		listening_ = false;
+	}
+}
+
+void ld2410Calibrator::finish_collecting_()
+{
+	if(samples() < 5)	//Not enough engineering frames arrived to say anything
+	{
+		end_engineering_mode_();
+		return;
+	}
+	for(uint8_t i = 0; i < 2 * LD2410_GATES; i++)
+	{
+		uint16_t threshold_ = (uint16_t)(estimators_[i].estimate() + 0.999f) + margin_;	//Round up, then add the margin
+		thresholds_[i] = threshold_ > 100 ? 100 : threshold_;
+	}
+	if(radar_.beginTransaction() == false)	//A command or the application's own transaction is in progress, never add to it
+	{
+		return;
+	}
+	bool queued_ = radar_.queueCommand(LD2410_CMD_END_ENGINEERING_MODE);	//End engineering mode and set every gate in one configuration session
+	for(uint8_t gate = 0; gate < LD2410_GATES && apply_ && queued_; gate++)
+	{
+		queued_ = radar_.queueGateSensitivityThreshold(gate, thresholds_[gate], thresholds_[LD2410_GATES + gate]);
+	}
+	if(queued_ == false)	//LD2410_MAX_QUEUED_COMMANDS is too small to hold every gate
+	{
+		radar_.cancelTransaction();
+		end_engineering_mode_();
+		return;
+	}
+	state_ = radar_.commitTransaction(false) ? LD2410_CALIBRATION_APPLYING : LD2410_CALIBRATION_FAILED;
+}
+
+void ld2410Calibrator::end_engineering_mode_()
+{
+	if(radar_.submitCommand(LD2410_CMD_END_ENGINEERING_MODE))	//Otherwise busy, update() tries again
+	{
+		state_ = LD2410_CALIBRATION_FAILED;
+	}
+}
+
+uint8_t ld2410Calibrator::threshold(uint8_t type, uint8_t gate)
+{
+	return thresholds_[type * LD2410_GATES + gate];
+}
+
+float ld2410Calibrator::energy(uint8_t type, uint8_t gate)
+{
+	return estimators_[type * LD2410_GATES + gate].estimate();
+}
+
+uint16_t ld2410Calibrator::samples()
+{
+	return estimators_[0].samples();
+}
+#endif
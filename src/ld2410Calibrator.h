@@ -0,0 +1,55 @@
+/*
+ *	Automatic empty-room calibration of the per-gate sensitivity thresholds.
+ *
+ *	Puts the sensor into engineering mode, estimates a high quantile of the moving and stationary energy at every gate over a
+ *	window with nobody present, then sets each threshold to that quantile plus a margin and ends engineering mode, all in one
+ *	configuration session. Everything is non-blocking, call update() and keep reading the sensor until it finishes. If a command
+ *	or a transaction of your own is in progress when the window ends, the calibrator waits for it rather than joining in.
+ *
+ *	The calibrator uses the sensor's data callback while it runs, set your own again once it has finished.
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#ifndef ld2410Calibrator_h
+#define ld2410Calibrator_h
+#include "ld2410.h"
+#include "ld2410Quantile.h"
+
+#define LD2410_CALIBRATION_IDLE 0											//State of the calibration
+#define LD2410_CALIBRATION_STARTING 1										//Entering engineering mode
+#define LD2410_CALIBRATION_COLLECTING 2										//Estimating gate energies
+#define LD2410_CALIBRATION_APPLYING 3										//Setting thresholds
+#define LD2410_CALIBRATION_DONE 4
+#define LD2410_CALIBRATION_FAILED 5
+
+class ld2410Calibrator	{
+
+	public:
+		ld2410Calibrator(ld2410 &radar);									//Constructor function
+		~ld2410Calibrator();												//Destructor function
+		bool begin(uint32_t duration = 30000, float quantile = 0.95, uint8_t margin = 10, bool apply = true);	//Start calibrating for duration ms, apply false only measures. False if the sensor is busy
+		uint8_t update();													//Call regularly, returns the state
+		uint8_t state();
+		uint8_t threshold(uint8_t type, uint8_t gate);						//Calculated threshold, type is LD2410_MOVING or LD2410_STATIONARY
+		float energy(uint8_t type, uint8_t gate);							//Estimated energy quantile in the empty room
+		uint16_t samples();													//Engineering frames used
+	protected:
+	private:
+		ld2410 &radar_;
+		ld2410Quantile estimators_[2 * LD2410_GATES];						//Moving gates then stationary gates
+		uint8_t thresholds_[2 * LD2410_GATES];
+		uint8_t state_ = LD2410_CALIBRATION_IDLE;
+		uint8_t margin_ = 10;
+		bool apply_ = true;
+		uint32_t duration_ = 0;
+		uint32_t started_ = 0;
+		bool listening_ = false;											//The data callback is set to frame_decoded_
+		static void frame_decoded_(const ld2410Reading &reading, void *context);	//Data callback from the ld2410
+		void stop_listening_();												//Remove the data callback if it is still ours
+		void finish_collecting_();											//Work out the thresholds and send them, or wait if the sensor is busy
+		void end_engineering_mode_();										//Give up, or wait if the sensor is busy
+};
+#endif
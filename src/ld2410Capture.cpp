@@ -0,0 +1,262 @@
+/*
+ *	Records the raw bytes received from an LD2410 with their arrival times, and plays them back as a Stream.
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#ifndef ld2410Capture_cpp
+#define ld2410Capture_cpp
+#include "ld2410Capture.h"
+
+ld2410Capture::ld2410Capture()	//Constructor function
+{
+}
+
+ld2410Capture::~ld2410Capture()	//Destructor function
+{
+	end();
+}
+
+bool ld2410Capture::begin(ld2410 &radar, Print &output)
+{
+	if(radar_ != nullptr)
+	{
+		return false;
+	}
+	const uint8_t header_[4] = {'L', 'D', 'C', LD2410_CAPTURE_VERSION};
+	output_ = &output;
+	block_length_ = 0;
+	previous_time_ = micros();
+	bytes_ = 0;
+	blocks_ = 0;
+	dropped_ = 0;
+	write_(header_, sizeof(header_));
+	radar_ = &radar;
+	radar_->setInputCallback(input_received_, this);
+	return true;
+}
+
+void ld2410Capture::end()
+{
+	if(radar_ == nullptr)
+	{
+		return;
+	}
+	radar_->setInputCallback(nullptr);
+	radar_ = nullptr;
+	flush();
+}
+
+void ld2410Capture::flush()
+{
+	if(block_length_ == 0)
+	{
+		return;
+	}
+	uint8_t block_header_[10];
+	uint8_t header_length_ = encode_varint_(block_time_ - previous_time_, block_header_);
+	header_length_ += encode_varint_(block_length_, &block_header_[header_length_]);
+	write_(block_header_, header_length_);
+	write_(block_, block_length_);
+	previous_time_ = block_time_;
+	block_length_ = 0;
+	blocks_++;
+}
+
+void ld2410Capture::add(const uint8_t *data, uint16_t length, uint32_t now)
+{
+	bytes_ += length;
+	if(block_length_ > 0 && now - block_time_ >= LD2410_CAPTURE_RESOLUTION)	//Too long after the block started to share its timestamp
+	{
+		flush();
+	}
+	while(length > 0)
+	{
+		if(block_length_ == 0)
+		{
+			block_time_ = now;
+		}
+		uint8_t space_ = LD2410_CAPTURE_BLOCK_LENGTH - block_length_;
+		uint8_t copy_ = length < space_ ? length : space_;
+		memcpy(&block_[block_length_], data, copy_);
+		block_length_ += copy_;
+		data += copy_;
+		length -= copy_;
+		if(block_length_ == LD2410_CAPTURE_BLOCK_LENGTH)
+		{
+			flush();
+		}
+	}
+}
+
+uint32_t ld2410Capture::bytes()
+{
+	return bytes_;
+}
+
+uint32_t ld2410Capture::blocks()
+{
+	return blocks_;
+}
+
+uint32_t ld2410Capture::dropped()
+{
+	return dropped_;
+}
+
+void ld2410Capture::write_(const uint8_t *data, uint8_t length)
+{
+	size_t written_ = output_->write(data, length);
+	if(written_ < length)
+	{
+		dropped_ += length - written_;
+	}
+}
+
+uint8_t ld2410Capture::encode_varint_(uint32_t value, uint8_t *buffer)
+{
+	uint8_t length_ = 0;
+	while(value >= 0x80)
+	{
+		buffer[length_++] = (value & 0x7F) | 0x80;
+		value >>= 7;
+	}
+	buffer[length_++] = value;
+	return length_;
+}
+
+void ld2410Capture::input_received_(const uint8_t *data, uint16_t length, void *context)
+{
+	static_cast<ld2410Capture *>(context)->add(data, length, micros());
+}
+
+ld2410Replay::ld2410Replay()	//Constructor function
+{
+}
+
+ld2410Replay::~ld2410Replay()	//Destructor function
+{
+}
+
+bool ld2410Replay::begin(Stream &capture, bool realTime)
+{
+	capture_ = &capture;
+	real_time_ = realTime;
+	remaining_ = 0;
+	bytes_ = 0;
+	finished_ = true;
+	if(capture_->read() != 'L' || capture_->read() != 'D' || capture_->read() != 'C' || capture_->read() != LD2410_CAPTURE_VERSION)
+	{
+		return false;
+	}
+	finished_ = false;
+	due_ = micros();
+	return true;
+}
+
+bool ld2410Replay::finished()
+{
+	if(remaining_ == 0 && finished_ == false)
+	{
+		next_block_();
+	}
+	return finished_;
+}
+
+uint32_t ld2410Replay::bytes()
+{
+	return bytes_;
+}
+
+int ld2410Replay::available()
+{
+	if(released_())
+	{
+		return remaining_;
+	}
+	return 0;
+}
+
+int ld2410Replay::read()
+{
+	if(released_() == false)
+	{
+		return -1;
+	}
+	int byte_read_ = capture_->read();
+	if(byte_read_ < 0)	//Truncated capture
+	{
+		remaining_ = 0;
+		finished_ = true;
+		return -1;
+	}
+	remaining_--;
+	bytes_++;
+	return byte_read_;
+}
+
+int ld2410Replay::peek()
+{
+	if(released_() == false)
+	{
+		return -1;
+	}
+	return capture_->peek();
+}
+
+size_t ld2410Replay::write(uint8_t)
+{
+	return 1;
+}
+
+bool ld2410Replay::next_block_()
+{
+	uint32_t delta_;
+	uint32_t length_;
+	while(finished_ == false && remaining_ == 0)	//Skip any empty blocks
+	{
+		if(read_varint_(delta_) == false || read_varint_(length_) == false || length_ > 0xFFFF)
+		{
+			finished_ = true;
+			return false;
+		}
+		due_ += delta_;
+		remaining_ = length_;
+	}
+	return true;
+}
+
+bool ld2410Replay::read_varint_(uint32_t &value)
+{
+	value = 0;
+	for(uint8_t shift_ = 0; shift_ < 35; shift_ += 7)
+	{
+		int byte_read_ = capture_->read();
+		if(byte_read_ < 0)
+		{
+			return false;
+		}
+		value |= (uint32_t)(byte_read_ & 0x7F) << shift_;
+		if((byte_read_ & 0x80) == 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool ld2410Replay::released_()
+{
+	if(finished_ || capture_ == nullptr)
+	{
+		return false;
+	}
+	if(remaining_ == 0 && next_block_() == false)
+	{
+		return false;
+	}
+	return real_time_ == false || (int32_t)(micros() - due_) >= 0;
+}
+#endif
@@ -0,0 +1,87 @@
+/*
+ *	Records the raw bytes received from an LD2410 with their arrival times, and plays them back as a Stream.
+ *
+ *	The capture format is a four byte header, 'L' 'D' 'C' and a version, followed by blocks of...
+ *
+ *	Microseconds since the previous block (or since capture started), as a varint
+ *	Number of bytes in the block, as a varint
+ *	The bytes themselves
+ *
+ *	Varints are little-endian base 128, seven bits per byte with the top bit set on all but the last. Bytes that arrive within
+ *	LD2410_CAPTURE_RESOLUTION of the start of a block share its timestamp, so a steady stream of frames costs about two bytes of
+ *	overhead per block. ld2410Capture hooks the input callback of an ld2410 and writes to any Print (a file, a spare UART etc.)
+ *	from a fixed block buffer, it never allocates. ld2410Replay reads a capture from any Stream and can be passed to
+ *	ld2410::begin() in place of the UART, releasing each block when it is due or as fast as it is read.
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#ifndef ld2410Capture_h
+#define ld2410Capture_h
+#include "ld2410.h"
+
+#define LD2410_CAPTURE_VERSION 1											//Written after the 'LDC' magic
+#ifndef LD2410_CAPTURE_BLOCK_LENGTH
+	#define LD2410_CAPTURE_BLOCK_LENGTH 64									//Most bytes buffered before a block is written
+#endif
+static_assert(LD2410_CAPTURE_BLOCK_LENGTH > 0 && LD2410_CAPTURE_BLOCK_LENGTH <= 255, "LD2410_CAPTURE_BLOCK_LENGTH must fit in the uint8_t block length");
+#ifndef LD2410_CAPTURE_RESOLUTION
+	#define LD2410_CAPTURE_RESOLUTION 1000									//Bytes arriving within this many us of the block start share its timestamp
+#endif
+
+class ld2410Capture	{
+
+	public:
+		ld2410Capture();													//Constructor function
+		~ld2410Capture();													//Destructor function, ends any capture
+		bool begin(ld2410 &radar, Print &output);							//Write the header and start capturing, false if already capturing
+		void end();															//Write what is buffered and stop capturing
+		void flush();														//Write what is buffered now, eg. before closing a file
+		void add(const uint8_t *data, uint16_t length, uint32_t now);		//Capture bytes that arrived at now (micros()), called from the input callback
+		uint32_t bytes();													//Raw bytes captured
+		uint32_t blocks();													//Blocks written
+		uint32_t dropped();													//Bytes of capture the output didn't accept
+	protected:
+	private:
+		ld2410 *radar_ = nullptr;
+		Print *output_ = nullptr;
+		uint8_t block_[LD2410_CAPTURE_BLOCK_LENGTH];
+		uint8_t block_length_ = 0;
+		uint32_t block_time_ = 0;											//micros() of the first byte in the block
+		uint32_t previous_time_ = 0;										//Timestamp of the previous block written
+		uint32_t bytes_ = 0;
+		uint32_t blocks_ = 0;
+		uint32_t dropped_ = 0;
+		void write_(const uint8_t *data, uint8_t length);
+		static uint8_t encode_varint_(uint32_t value, uint8_t *buffer);		//Returns the bytes used, at most five
+		static void input_received_(const uint8_t *data, uint16_t length, void *context);	//Input callback from the ld2410
+};
+
+class ld2410Replay : public Stream	{
+
+	public:
+		ld2410Replay();														//Constructor function
+		~ld2410Replay();													//Destructor function
+		bool begin(Stream &capture, bool realTime = true);					//Check the header and start playing, realTime false plays as fast as it is read
+		bool finished();													//The whole capture has been played
+		uint32_t bytes();													//Raw bytes played so far
+		int available();
+		int read();
+		int peek();
+		size_t write(uint8_t);												//Commands sent to a replay are discarded
+		using Print::write;
+	protected:
+	private:
+		Stream *capture_ = nullptr;
+		bool real_time_ = true;
+		bool finished_ = true;
+		uint16_t remaining_ = 0;											//Bytes left in the current block
+		uint32_t due_ = 0;													//micros() when the current block is released
+		uint32_t bytes_ = 0;
+		bool next_block_();													//Read the next block header
+		bool read_varint_(uint32_t &value);
+		bool released_();													//The current block can be read
+};
+#endif
@@ -0,0 +1,254 @@
+/*
+ *	Encoding and decoding of LD2410 frames, with no dependency on Arduino or any Stream.
+ *
+ *	Command frames with fixed values are built at compile time, and kept in flash on AVR, by ld2410CommandFrame and
+ *	ld2410ValueCommandFrame. Others are encoded into a buffer by ld2410Codec::encodeCommand(), so either way a command goes out in
+ *	a single write(). The decoders take a complete frame, header to footer, and fill in typed structs.
+ *
+ *	Everything is in this header so it can be built and tested on its own, eg. on Linux.
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#ifndef ld2410Codec_h
+#define ld2410Codec_h
+#include <stdint.h>
+#include <string.h>
+#if defined(__AVR__)
+	#include <avr/pgmspace.h>
+	#define LD2410_CODEC_PROGMEM PROGMEM									//Fixed frames are copied out of flash before sending
+#else
+	#define LD2410_CODEC_PROGMEM
+#endif
+
+#define LD2410_MAX_FRAME_LENGTH 46
+#define LD2410_MAX_COMMAND_LENGTH 30										//Longest encoded command, set max values/gate sensitivity
+#define LD2410_GATES 9													//Distance gates reported in engineering mode
+
+#define LD2410_CMD_SET_MAX_VALUES 0x60									//Command opcodes, the ACK for each echoes the opcode
+#define LD2410_CMD_READ_CONFIGURATION 0x61
+#define LD2410_CMD_START_ENGINEERING_MODE 0x62
+#define LD2410_CMD_END_ENGINEERING_MODE 0x63
+#define LD2410_CMD_SET_GATE_SENSITIVITY 0x64
+#define LD2410_CMD_READ_FIRMWARE_VERSION 0xA0
+#define LD2410_CMD_SET_BAUD_RATE 0xA1
+#define LD2410_CMD_FACTORY_RESET 0xA2
+#define LD2410_CMD_RESTART 0xA3
+#define LD2410_CMD_SET_BLUETOOTH 0xA4
+#define LD2410_CMD_GET_MAC 0xA5
+#define LD2410_CMD_SET_RESOLUTION 0xAA
+#define LD2410_CMD_READ_RESOLUTION 0xAB
+#define LD2410_CMD_LEAVE_CONFIGURATION 0xFE
+#define LD2410_CMD_ENTER_CONFIGURATION 0xFF
+
+#define LD2410_DECODE_OK 0												//Result of decoding a data frame
+#define LD2410_DECODE_BAD_LENGTH 1										//The length field doesn't match the frame
+#define LD2410_DECODE_UNKNOWN 2											//Not a type of data frame this understands
+
+struct ld2410Reading {													//Snapshot of one decoded data frame
+	uint16_t movingTargetDistance;										//cm
+	uint16_t stationaryTargetDistance;									//cm
+	uint16_t detectionDistance;											//cm
+	uint8_t targetType;													//0 none, bit 0 moving, bit 1 stationary
+	uint8_t movingTargetEnergy;											//0-100
+	uint8_t stationaryTargetEnergy;										//0-100
+	bool engineeringData;												//Whether the gate energies below are present
+	uint8_t movingGateEnergy[LD2410_GATES];
+	uint8_t stationaryGateEnergy[LD2410_GATES];
+};
+
+struct ld2410Ack {														//An ACK frame split into its parts
+	uint8_t command;													//The opcode acknowledged
+	bool success;
+	uint16_t dataLength;												//The intra-frame data length, used to recognise the ACK
+	const uint8_t *payload;												//What follows the status word, points into the frame
+	uint16_t payloadLength;
+};
+
+struct ld2410FirmwareVersion {
+	uint8_t major;
+	uint8_t minor;
+	uint32_t bugfix;													//Coded as hex
+};
+
+struct ld2410Configuration {
+	uint8_t maxGate;
+	uint8_t maxMovingGate;
+	uint8_t maxStationaryGate;
+	uint8_t motionSensitivity[LD2410_GATES];
+	uint8_t stationarySensitivity[LD2410_GATES];
+	uint16_t idleTime;													//Seconds
+};
+
+template<uint8_t command> struct ld2410CommandFrame	{						//A command with no value, built at compile time
+	static constexpr uint8_t length = 12;
+	static constexpr uint8_t frame[12] LD2410_CODEC_PROGMEM = {0xFD, 0xFC, 0xFB, 0xFA, 0x02, 0x00, command, 0x00, 0x04, 0x03, 0x02, 0x01};
+};
+template<uint8_t command> constexpr uint8_t ld2410CommandFrame<command>::frame[12] LD2410_CODEC_PROGMEM;
+
+template<uint8_t command, uint16_t value> struct ld2410ValueCommandFrame	{	//A command with one fixed 16-bit value, built at compile time
+	static constexpr uint8_t length = 14;
+	static constexpr uint8_t frame[14] LD2410_CODEC_PROGMEM = {0xFD, 0xFC, 0xFB, 0xFA, 0x04, 0x00, command, 0x00, value & 0xFF, value >> 8, 0x04, 0x03, 0x02, 0x01};
+};
+template<uint8_t command, uint16_t value> constexpr uint8_t ld2410ValueCommandFrame<command, value>::frame[14] LD2410_CODEC_PROGMEM;
+
+class ld2410Codec	{
+
+	public:
+		static void copyFrame(uint8_t *buffer, const uint8_t *frame, uint8_t length)	//Copy a compile time frame into RAM, from flash on AVR
+		{
+			#if defined(__AVR__)
+			memcpy_P(buffer, frame, length);
+			#else
+			memcpy(buffer, frame, length);
+			#endif
+		}
+		static uint8_t encodeCommand(uint8_t *buffer, uint8_t command, uint16_t value0 = 0, uint16_t value1 = 0, uint16_t value2 = 0)	//Into at least LD2410_MAX_COMMAND_LENGTH bytes, returns the length
+		{
+			uint8_t length_ = 0;
+			buffer[length_++] = 0xFD;	//Header
+			buffer[length_++] = 0xFC;
+			buffer[length_++] = 0xFB;
+			buffer[length_++] = 0xFA;
+			uint8_t *data_length_ = &buffer[length_];
+			length_ += 2;
+			buffer[length_++] = command;
+			buffer[length_++] = 0x00;
+			if(command == LD2410_CMD_SET_MAX_VALUES || command == LD2410_CMD_SET_GATE_SENSITIVITY)	//Three parameter words, each followed by a 32-bit value
+			{
+				const uint16_t values_[3] = {value0, value1, value2};
+				for(uint8_t i = 0; i < 3; i++)
+				{
+					buffer[length_++] = i;	//Parameter word
+					buffer[length_++] = 0x00;
+					buffer[length_++] = values_[i] & 0xFF;	//Parameter value
+					buffer[length_++] = values_[i] >> 8;
+					buffer[length_++] = 0x00;	//Spacer
+					buffer[length_++] = 0x00;
+				}
+			}
+			else if(command == LD2410_CMD_ENTER_CONFIGURATION || command == LD2410_CMD_GET_MAC)	//Fixed value of 1
+			{
+				buffer[length_++] = 0x01;
+				buffer[length_++] = 0x00;
+			}
+			else if(command == LD2410_CMD_SET_RESOLUTION || command == LD2410_CMD_SET_BLUETOOTH || command == LD2410_CMD_SET_BAUD_RATE)	//One 16-bit value
+			{
+				buffer[length_++] = value0 & 0xFF;
+				buffer[length_++] = value0 >> 8;
+			}
+			data_length_[0] = length_ - 6;	//Opcode onwards
+			data_length_[1] = 0x00;
+			buffer[length_++] = 0x04;	//Footer
+			buffer[length_++] = 0x03;
+			buffer[length_++] = 0x02;
+			buffer[length_++] = 0x01;
+			return length_;
+		}
+		static uint16_t dataLength(const uint8_t *frame)				//The intra-frame data length from the header
+		{
+			return frame[4] + (frame[5] << 8);
+		}
+		static uint8_t decodeData(const uint8_t *frame, uint16_t length, ld2410Reading &reading)	//Returns one of LD2410_DECODE_
+		{
+			if(length < 10 || length != dataLength(frame) + 10)
+			{
+				return LD2410_DECODE_BAD_LENGTH;
+			}
+			uint16_t data_length_ = dataLength(frame);
+			if(data_length_ >= 13 && frame[6] == 0x01 && frame[7] == 0xAA)	//Engineering mode data
+			{
+				reading.targetType = frame[8];
+				reading.movingTargetDistance = frame[9] + (frame[10] << 8);
+				reading.movingTargetEnergy = frame[11];
+				reading.stationaryTargetDistance = frame[12] + (frame[13] << 8);
+				reading.stationaryTargetEnergy = frame[14];
+				reading.detectionDistance = frame[15] + (frame[16] << 8);
+				reading.engineeringData = data_length_ > 30;
+				if(reading.engineeringData)	//Moving then stationary energy for each gate
+				{
+					memcpy(reading.movingGateEnergy, &frame[19], LD2410_GATES);
+					memcpy(reading.stationaryGateEnergy, &frame[28], LD2410_GATES);
+				}
+				else
+				{
+					memset(reading.movingGateEnergy, 0, LD2410_GATES);
+					memset(reading.stationaryGateEnergy, 0, LD2410_GATES);
+				}
+				return LD2410_DECODE_OK;
+			}
+			if(data_length_ == 13 && frame[6] == 0x02 && frame[7] == 0xAA && frame[17] == 0x55 && frame[18] == 0x00)	//Normal target data
+			{
+				reading.targetType = frame[8];
+				reading.stationaryTargetDistance = frame[9] + (frame[10] << 8);	//As this library has always reported them
+				reading.movingTargetEnergy = frame[11];
+				reading.stationaryTargetEnergy = frame[14];
+				reading.movingTargetDistance = frame[15] + (frame[16] << 8);
+				reading.detectionDistance = frame[15] + (frame[16] << 8);
+				reading.engineeringData = false;
+				memset(reading.movingGateEnergy, 0, LD2410_GATES);
+				memset(reading.stationaryGateEnergy, 0, LD2410_GATES);
+				return LD2410_DECODE_OK;
+			}
+			return LD2410_DECODE_UNKNOWN;
+		}
+		static bool decodeAck(const uint8_t *frame, uint16_t length, ld2410Ack &ack)	//False if it is too short to be an ACK
+		{
+			if(length < 14 || length != dataLength(frame) + 10)
+			{
+				return false;
+			}
+			ack.command = frame[6];
+			ack.success = frame[8] == 0x00 && frame[9] == 0x00;
+			ack.dataLength = dataLength(frame);
+			ack.payload = &frame[10];
+			ack.payloadLength = ack.dataLength - 4;
+			return true;
+		}
+		static bool decodeFirmwareVersion(const ld2410Ack &ack, ld2410FirmwareVersion &version)
+		{
+			if(ack.command != LD2410_CMD_READ_FIRMWARE_VERSION || ack.payloadLength < 8)
+			{
+				return false;
+			}
+			version.major = ack.payload[3];
+			version.minor = ack.payload[2];
+			version.bugfix = ack.payload[4] + ((uint32_t)ack.payload[5] << 8) + ((uint32_t)ack.payload[6] << 16) + ((uint32_t)ack.payload[7] << 24);
+			return true;
+		}
+		static bool decodeConfiguration(const ld2410Ack &ack, ld2410Configuration &configuration)
+		{
+			if(ack.command != LD2410_CMD_READ_CONFIGURATION || ack.payloadLength < 24)
+			{
+				return false;
+			}
+			configuration.maxGate = ack.payload[1];
+			configuration.maxMovingGate = ack.payload[2];
+			configuration.maxStationaryGate = ack.payload[3];
+			memcpy(configuration.motionSensitivity, &ack.payload[4], LD2410_GATES);
+			memcpy(configuration.stationarySensitivity, &ack.payload[13], LD2410_GATES);
+			configuration.idleTime = ack.payload[22] + (ack.payload[23] << 8);
+			return true;
+		}
+		static bool decodeResolution(const ld2410Ack &ack, uint8_t &resolution)
+		{
+			if(ack.command != LD2410_CMD_READ_RESOLUTION || ack.payloadLength < 2)
+			{
+				return false;
+			}
+			resolution = ack.payload[0];
+			return true;
+		}
+		static bool decodeMac(const ld2410Ack &ack, uint8_t *mac)		//Six bytes
+		{
+			if(ack.command != LD2410_CMD_GET_MAC || ack.payloadLength < 6)
+			{
+				return false;
+			}
+			memcpy(mac, ack.payload, 6);
+			return true;
+		}
+};
+#endif
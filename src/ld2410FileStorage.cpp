@@ -0,0 +1,70 @@
+/*
+ *	ld2410Storage using one file per key in a directory, for Linux.
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#ifndef ld2410FileStorage_cpp
+#define ld2410FileStorage_cpp
+#include "ld2410FileStorage.h"
+#if defined(__linux__)
+#include <stdio.h>
+
+ld2410FileStorage::ld2410FileStorage(const char *directory) :	//Constructor function
+	directory_(directory)
+{
+}
+
+ld2410FileStorage::~ld2410FileStorage()	//Destructor function
+{
+}
+
+bool ld2410FileStorage::load(const char *key, uint8_t *data, uint16_t length)
+{
+	char path_name_[LD2410_STORAGE_PATH_LENGTH];
+	if(path_(path_name_, key, "") == false)
+	{
+		return false;
+	}
+	FILE *file_ = fopen(path_name_, "rb");
+	if(file_ == nullptr)
+	{
+		return false;
+	}
+	bool loaded_ = fread(data, 1, length, file_) == length && fgetc(file_) == EOF;	//Exactly the length expected
+	fclose(file_);
+	return loaded_;
+}
+
+bool ld2410FileStorage::save(const char *key, const uint8_t *data, uint16_t length)
+{
+	char path_name_[LD2410_STORAGE_PATH_LENGTH];
+	char temporary_name_[LD2410_STORAGE_PATH_LENGTH];
+	if(path_(path_name_, key, "") == false || path_(temporary_name_, key, ".tmp") == false)
+	{
+		return false;
+	}
+	FILE *file_ = fopen(temporary_name_, "wb");
+	if(file_ == nullptr)
+	{
+		return false;
+	}
+	bool written_ = fwrite(data, 1, length, file_) == length;
+	written_ = fclose(file_) == 0 && written_;
+	if(written_ == false)
+	{
+		remove(temporary_name_);
+		return false;
+	}
+	return rename(temporary_name_, path_name_) == 0;
+}
+
+bool ld2410FileStorage::path_(char *path, const char *key, const char *suffix)
+{
+	int length_ = snprintf(path, LD2410_STORAGE_PATH_LENGTH, "%s/%s%s", directory_, key, suffix);
+	return length_ > 0 && length_ < LD2410_STORAGE_PATH_LENGTH;
+}
+#endif
+#endif
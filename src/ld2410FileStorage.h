@@ -0,0 +1,30 @@
+/*
+ *	ld2410Storage using one file per key in a directory, for Linux.
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#ifndef ld2410FileStorage_h
+#define ld2410FileStorage_h
+#include "ld2410Storage.h"
+#if defined(__linux__)
+#include <stddef.h>
+
+#define LD2410_STORAGE_PATH_LENGTH 256										//Longest directory plus key
+
+class ld2410FileStorage : public ld2410Storage	{
+
+	public:
+		ld2410FileStorage(const char *directory = ".");						//Constructor function, the directory must already exist
+		~ld2410FileStorage();												//Destructor function
+		bool load(const char *key, uint8_t *data, uint16_t length) override;
+		bool save(const char *key, const uint8_t *data, uint16_t length) override;	//Written to a temporary file then renamed, so a crash leaves the old value
+	protected:
+	private:
+		const char *directory_;
+		bool path_(char *path, const char *key, const char *suffix);		//Build the file name, false if it is too long
+};
+#endif
+#endif
@@ -0,0 +1,115 @@
+/*
+ *	Streaming per-gate energy statistics for engineering mode data.
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#ifndef ld2410GateStatistics_cpp
+#define ld2410GateStatistics_cpp
+#include "ld2410GateStatistics.h"
+
+ld2410GateStatistics::ld2410GateStatistics(float ewmaWeight) :	//Constructor function
+	ewma_weight_(ewmaWeight)
+{
+	reset();
+}
+
+ld2410GateStatistics::~ld2410GateStatistics()	//Destructor function
+{
+}
+
+void ld2410GateStatistics::reset()
+{
+	samples_ = 0;
+	memset(minimum_, 0, sizeof(minimum_));
+	memset(maximum_, 0, sizeof(maximum_));
+	for(uint8_t i = 0; i < 2 * LD2410_GATES; i++)
+	{
+		mean_[i] = 0;
+		m2_[i] = 0;
+		ewma_[i] = 0;
+	}
+}
+
+bool ld2410GateStatistics::update(const ld2410Reading &reading)
+{
+	if(reading.engineeringData == false)
+	{
+		return false;
+	}
+	update(reading.movingGateEnergy, reading.stationaryGateEnergy);
+	return true;
+}
+
+void ld2410GateStatistics::update(const uint8_t *moving, const uint8_t *stationary)
+{
+	uint8_t energy_[2 * LD2410_GATES];
+	memcpy(energy_, moving, LD2410_GATES);
+	memcpy(&energy_[LD2410_GATES], stationary, LD2410_GATES);
+	samples_++;
+	if(samples_ == 1)	//The first frame sets everything
+	{
+		for(uint8_t i = 0; i < 2 * LD2410_GATES; i++)
+		{
+			minimum_[i] = energy_[i];
+			maximum_[i] = energy_[i];
+			mean_[i] = energy_[i];
+			ewma_[i] = energy_[i];
+		}
+		return;
+	}
+	float reciprocal_ = 1.0f / samples_;	//One division per frame rather than per gate
+	for(uint8_t i = 0; i < 2 * LD2410_GATES; i++)
+	{
+		float value_ = energy_[i];
+		if(energy_[i] < minimum_[i])
+		{
+			minimum_[i] = energy_[i];
+		}
+		if(energy_[i] > maximum_[i])
+		{
+			maximum_[i] = energy_[i];
+		}
+		float delta_ = value_ - mean_[i];
+		mean_[i] += delta_ * reciprocal_;
+		m2_[i] += delta_ * (value_ - mean_[i]);
+		ewma_[i] += ewma_weight_ * (value_ - ewma_[i]);
+	}
+}
+
+uint32_t ld2410GateStatistics::samples()
+{
+	return samples_;
+}
+
+uint8_t ld2410GateStatistics::minimum(uint8_t type, uint8_t gate)
+{
+	return minimum_[type * LD2410_GATES + gate];
+}
+
+uint8_t ld2410GateStatistics::maximum(uint8_t type, uint8_t gate)
+{
+	return maximum_[type * LD2410_GATES + gate];
+}
+
+float ld2410GateStatistics::mean(uint8_t type, uint8_t gate)
+{
+	return mean_[type * LD2410_GATES + gate];
+}
+
+float ld2410GateStatistics::variance(uint8_t type, uint8_t gate)
+{
+	if(samples_ < 2)
+	{
+		return 0;
+	}
+	return m2_[type * LD2410_GATES + gate] / (samples_ - 1);
+}
+
+float ld2410GateStatistics::ewma(uint8_t type, uint8_t gate)
+{
+	return ewma_[type * LD2410_GATES + gate];
+}
+#endif
@@ -0,0 +1,40 @@
+/*
+ *	Streaming per-gate energy statistics for engineering mode data.
+ *
+ *	Keeps a running minimum, maximum, mean, variance and exponentially weighted moving average for the moving and stationary energy
+ *	of every gate in fixed memory, updating all of them in one pass per frame. Feed it from a data callback.
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#ifndef ld2410GateStatistics_h
+#define ld2410GateStatistics_h
+#include "ld2410.h"
+
+class ld2410GateStatistics	{
+
+	public:
+		ld2410GateStatistics(float ewmaWeight = 0.1);						//Constructor function, the weight given to each new frame in the EWMA
+		~ld2410GateStatistics();											//Destructor function
+		void reset();														//Forget everything seen so far
+		bool update(const ld2410Reading &reading);							//Add a frame, false if it has no gate energies
+		void update(const uint8_t *moving, const uint8_t *stationary);		//Add LD2410_GATES energies of each type
+		uint32_t samples();													//Frames added since the last reset
+		uint8_t minimum(uint8_t type, uint8_t gate);						//type is LD2410_MOVING or LD2410_STATIONARY
+		uint8_t maximum(uint8_t type, uint8_t gate);
+		float mean(uint8_t type, uint8_t gate);
+		float variance(uint8_t type, uint8_t gate);							//Sample variance
+		float ewma(uint8_t type, uint8_t gate);
+	protected:
+	private:
+		float ewma_weight_;
+		uint32_t samples_ = 0;
+		uint8_t minimum_[2 * LD2410_GATES];									//Struct of arrays, moving gates then stationary gates
+		uint8_t maximum_[2 * LD2410_GATES];
+		float mean_[2 * LD2410_GATES];
+		float m2_[2 * LD2410_GATES];										//Sum of squared differences from the mean (Welford)
+		float ewma_[2 * LD2410_GATES];
+};
+#endif
@@ -0,0 +1,90 @@
+/*
+ *	Services several LD2410 sensors from one poll loop, sharing the time fairly between them.
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#ifndef ld2410Manager_cpp
+#define ld2410Manager_cpp
+#include "ld2410Manager.h"
+
+const ld2410SensorHealth ld2410Manager::no_health_ = {};
+
+ld2410Manager::ld2410Manager()	//Constructor function
+{
+}
+
+ld2410Manager::~ld2410Manager()	//Destructor function
+{
+}
+
+bool ld2410Manager::add(ld2410 &sensor)
+{
+	if(sensor_count_ == LD2410_MAX_SENSORS)
+	{
+		return false;
+	}
+	sensors_[sensor_count_] = &sensor;
+	memset(&health_[sensor_count_], 0, sizeof(ld2410SensorHealth));
+	sensor_count_++;
+	return true;
+}
+
+uint8_t ld2410Manager::sensors()
+{
+	return sensor_count_;
+}
+
+ld2410 *ld2410Manager::sensor(uint8_t index)
+{
+	if(index >= sensor_count_)
+	{
+		return nullptr;
+	}
+	return sensors_[index];
+}
+
+void ld2410Manager::setBudget(uint16_t bytes)
+{
+	budget_ = bytes;
+}
+
+uint16_t ld2410Manager::poll()
+{
+	uint16_t frames_decoded_ = 0;
+	uint32_t now_ = millis();
+	for(uint8_t i = 0; i < sensor_count_; i++)
+	{
+		uint8_t index_ = (next_sensor_ + i) % sensor_count_;
+		ld2410SensorHealth &health_of_ = health_[index_];
+		uint16_t frames_ = sensors_[index_]->readAvailable(&health_of_.bytesPending, budget_);
+		if(frames_ > 0)
+		{
+			health_of_.framesDecoded += frames_;
+			health_of_.lastFrame = now_;
+			frames_decoded_ += frames_;
+		}
+		if(health_of_.bytesPending > health_of_.maxBytesPending)
+		{
+			health_of_.maxBytesPending = health_of_.bytesPending;
+		}
+		health_of_.connected = health_of_.framesDecoded > 0 && now_ - health_of_.lastFrame < LD2410_MANAGER_TIMEOUT;
+	}
+	if(sensor_count_ > 0)
+	{
+		next_sensor_ = (next_sensor_ + 1) % sensor_count_;
+	}
+	return frames_decoded_;
+}
+
+const ld2410SensorHealth &ld2410Manager::health(uint8_t index)
+{
+	if(index >= sensor_count_)
+	{
+		return no_health_;
+	}
+	return health_[index];
+}
+#endif
@@ -0,0 +1,51 @@
+/*
+ *	Services several LD2410 sensors from one poll loop, sharing the time fairly between them.
+ *
+ *	Each call to poll() drains up to a budget of bytes from every sensor, starting with a different sensor each time, and keeps
+ *	a health record per sensor. Use the non-blocking command methods (submitCommand()/commitTransaction(false)) on managed sensors,
+ *	a blocking command stalls the others for its duration.
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#ifndef ld2410Manager_h
+#define ld2410Manager_h
+#include "ld2410.h"
+
+#ifndef LD2410_MAX_SENSORS
+	#define LD2410_MAX_SENSORS 4											//Sensors one manager can hold
+#endif
+#define LD2410_MANAGER_BUDGET 64											//Default bytes drained from each sensor per poll()
+#define LD2410_MANAGER_TIMEOUT 1000										//A sensor is disconnected if it hasn't sent a frame for this long (ms)
+
+struct ld2410SensorHealth {													//Per sensor statistics kept by the manager
+	uint32_t framesDecoded;													//Frames decoded since it was added
+	uint32_t lastFrame;														//millis() of the last frame decoded
+	uint16_t bytesPending;													//Bytes left waiting after the last poll
+	uint16_t maxBytesPending;												//Worst backlog seen, close to the UART buffer size means frames are being lost
+	bool connected;															//Frame received within LD2410_MANAGER_TIMEOUT
+};
+
+class ld2410Manager	{
+
+	public:
+		ld2410Manager();													//Constructor function
+		~ld2410Manager();													//Destructor function
+		bool add(ld2410 &sensor);											//Add a sensor that has already had begin() called, false if full
+		uint8_t sensors();													//Number of sensors added
+		ld2410 *sensor(uint8_t index);										//Access a sensor, eg. to send it commands, nullptr if index is past the last one added
+		void setBudget(uint16_t bytes);										//Bytes drained from each sensor per poll()
+		uint16_t poll();													//Service every sensor once, returns frames decoded across them all
+		const ld2410SensorHealth &health(uint8_t index);					//Health of a sensor, updated by poll(), all zero if index is past the last one added
+	protected:
+	private:
+		ld2410 *sensors_[LD2410_MAX_SENSORS];
+		ld2410SensorHealth health_[LD2410_MAX_SENSORS];
+		static const ld2410SensorHealth no_health_;							//Returned for an index out of range
+		uint8_t sensor_count_ = 0;
+		uint8_t next_sensor_ = 0;											//Where the next poll() starts, so no sensor always goes first
+		uint16_t budget_ = LD2410_MANAGER_BUDGET;
+};
+#endif
@@ -0,0 +1,149 @@
+/*
+ *	The parts of the Arduino core the library uses, for building it natively on Linux.
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#ifndef ld2410Port_cpp
+#define ld2410Port_cpp
+#include "ld2410Port.h"
+#ifdef LD2410_LINUX_PORT
+#include <stdio.h>
+#include <time.h>
+#include <errno.h>
+
+uint32_t millis()
+{
+	struct timespec now_;
+	clock_gettime(CLOCK_MONOTONIC, &now_);
+	return (uint32_t)(now_.tv_sec * 1000ULL + now_.tv_nsec / 1000000);
+}
+
+uint32_t micros()
+{
+	struct timespec now_;
+	clock_gettime(CLOCK_MONOTONIC, &now_);
+	return (uint32_t)(now_.tv_sec * 1000000ULL + now_.tv_nsec / 1000);
+}
+
+void delay(unsigned long ms)
+{
+	struct timespec remaining_;
+	remaining_.tv_sec = ms / 1000;
+	remaining_.tv_nsec = (ms % 1000) * 1000000L;
+	while(nanosleep(&remaining_, &remaining_) != 0 && errno == EINTR)	//Carry on after signals
+	{
+	}
+}
+
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+	size_t written_ = 0;
+	while(written_ < size && write(buffer[written_]) == 1)
+	{
+		written_++;
+	}
+	return written_;
+}
+
+size_t Print::write(const char *str)
+{
+	return write((const uint8_t *)str, strlen(str));
+}
+
+size_t Print::print(const __FlashStringHelper *str)
+{
+	return write(reinterpret_cast<const char *>(str));
+}
+
+size_t Print::print(const char *str)
+{
+	return write(str);
+}
+
+size_t Print::print(char c)
+{
+	return write((uint8_t)c);
+}
+
+size_t Print::print(unsigned char value, int base)
+{
+	return print((unsigned long)value, base);
+}
+
+size_t Print::print(int value, int base)
+{
+	return print((long)value, base);
+}
+
+size_t Print::print(unsigned int value, int base)
+{
+	return print((unsigned long)value, base);
+}
+
+size_t Print::print(long value, int base)
+{
+	if(base == DEC)
+	{
+		char text_[24];
+		snprintf(text_, sizeof(text_), "%ld", value);
+		return write(text_);
+	}
+	return print((unsigned long)value, base);
+}
+
+size_t Print::print(unsigned long value, int base)
+{
+	char text_[24];
+	snprintf(text_, sizeof(text_), base == HEX ? "%lX" : "%lu", value);
+	return write(text_);
+}
+
+size_t Print::print(double value, int digits)
+{
+	char text_[32];
+	snprintf(text_, sizeof(text_), "%.*f", digits, value);
+	return write(text_);
+}
+
+size_t Print::println()
+{
+	return write("\r\n");
+}
+
+void Stream::setTimeout(unsigned long timeout)
+{
+	timeout_ = timeout;
+}
+
+size_t Stream::readBytes(uint8_t *buffer, size_t length)
+{
+	size_t count_ = 0;
+	uint32_t start_ = millis();
+	while(count_ < length)
+	{
+		int byte_read_ = read();
+		if(byte_read_ >= 0)
+		{
+			buffer[count_++] = byte_read_;
+		}
+		else if(millis() - start_ >= timeout_)
+		{
+			break;
+		}
+		else
+		{
+			delay(1);
+		}
+	}
+	return count_;
+}
+
+size_t Stream::readBytes(char *buffer, size_t length)
+{
+	return readBytes((uint8_t *)buffer, length);
+}
+#endif
+#endif
@@ -0,0 +1,81 @@
+/*
+ *	The parts of the Arduino core the library uses, for building it natively on Linux, eg. on a single-board computer.
+ *
+ *	Only used when ARDUINO isn't defined. millis(), micros() and delay() are based on the monotonic clock and Print/Stream
+ *	cover what the library and its debugging need. ld2410Serial, from ld2410Serial.h, is a Stream over a serial device.
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#ifndef ld2410Port_h
+#define ld2410Port_h
+#if defined(__linux__) && !defined(ARDUINO)
+#define LD2410_LINUX_PORT
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+typedef uint8_t byte;
+class __FlashStringHelper;												//Strings are never in a separate address space on Linux
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper *>(string_literal))
+#define PROGMEM
+#define pgm_read_byte(address) (*(const uint8_t *)(address))
+#define pgm_read_word(address) (*(const uint16_t *)(address))
+#define pgm_read_dword(address) (*(const uint32_t *)(address))
+#define pgm_read_ptr(address) (*(void * const *)(address))
+#define memcpy_P memcpy
+#define DEC 10
+#define HEX 16
+
+uint32_t millis();														//Milliseconds from the monotonic clock, 32 bits so differences wrap as on Arduino
+uint32_t micros();
+void delay(unsigned long ms);
+
+class Print	{
+
+	public:
+		virtual ~Print() {}
+		virtual size_t write(uint8_t) = 0;
+		virtual size_t write(const uint8_t *buffer, size_t size);
+		size_t write(const char *str);
+		virtual void flush() {}
+		size_t print(const __FlashStringHelper *str);
+		size_t print(const char *str);
+		size_t print(char c);
+		size_t print(unsigned char value, int base = DEC);
+		size_t print(int value, int base = DEC);
+		size_t print(unsigned int value, int base = DEC);
+		size_t print(long value, int base = DEC);
+		size_t print(unsigned long value, int base = DEC);
+		size_t print(double value, int digits = 2);
+		size_t println();
+		template<class T> size_t println(T value)
+		{
+			size_t length_ = print(value);
+			return length_ + println();
+		}
+		template<class T> size_t println(T value, int format)
+		{
+			size_t length_ = print(value, format);
+			return length_ + println();
+		}
+};
+
+class Stream : public Print	{
+
+	public:
+		virtual int available() = 0;
+		virtual int read() = 0;
+		virtual int peek() = 0;
+		void setTimeout(unsigned long timeout);							//For readBytes(), ms
+		size_t readBytes(uint8_t *buffer, size_t length);				//Stops early after the timeout, as on Arduino
+		size_t readBytes(char *buffer, size_t length);
+	protected:
+		unsigned long timeout_ = 1000;
+};
+#elif !defined(ARDUINO)
+#error The ld2410 library needs the Arduino core or Linux
+#endif
+#endif
@@ -0,0 +1,138 @@
+/*
+ *	Debounced presence detection with hysteresis.
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#ifndef ld2410Presence_cpp
+#define ld2410Presence_cpp
+#include "ld2410Presence.h"
+
+ld2410Presence::ld2410Presence()	//Constructor function
+{
+}
+
+ld2410Presence::~ld2410Presence()	//Destructor function
+{
+}
+
+void ld2410Presence::setEnergyThresholds(uint8_t enter, uint8_t exit)
+{
+	enter_energy_ = (uint16_t)enter << 8;
+	exit_energy_ = (uint16_t)exit << 8;
+}
+
+void ld2410Presence::setDistanceThresholds(uint16_t enter, uint16_t exit)
+{
+	enter_distance_ = enter;
+	exit_distance_ = exit;
+}
+
+void ld2410Presence::setDwellTimes(uint32_t enter, uint32_t exit)
+{
+	enter_dwell_ = enter;
+	exit_dwell_ = exit;
+}
+
+void ld2410Presence::setSmoothing(uint8_t shift)
+{
+	smoothing_ = shift > 7 ? 7 : shift;
+}
+
+void ld2410Presence::setCallback(ld2410PresenceCallback callback, void *context)
+{
+	callback_ = callback;
+	callback_context_ = context;
+}
+
+void ld2410Presence::reset()
+{
+	energy_ = 0;
+	distance_ = 0;
+	present_ = false;
+	pending_ = false;
+	changes_ = 0;
+}
+
+bool ld2410Presence::update(const ld2410Reading &reading)
+{
+	return update(reading, millis());
+}
+
+bool ld2410Presence::update(const ld2410Reading &reading, uint32_t now)
+{
+	uint8_t frame_energy_ = 0;	//Strongest target in this frame, frames without one keep the last distance
+	if((reading.targetType & 0x01) && reading.movingTargetEnergy > 0)
+	{
+		frame_energy_ = reading.movingTargetEnergy;
+		distance_ = reading.movingTargetDistance;
+	}
+	if((reading.targetType & 0x02) && reading.stationaryTargetEnergy > frame_energy_)
+	{
+		frame_energy_ = reading.stationaryTargetEnergy;
+		distance_ = reading.stationaryTargetDistance;
+	}
+	uint16_t target_ = (uint16_t)frame_energy_ << 8;
+	if(target_ > energy_)	//Move 1/2^smoothing of the way towards this frame, kept unsigned
+	{
+		energy_ += (target_ - energy_ + (1 << smoothing_) - 1) >> smoothing_;
+	}
+	else
+	{
+		energy_ -= (energy_ - target_) >> smoothing_;
+	}
+	bool opposite_;	//Does this frame argue for the other state
+	if(present_)
+	{
+		opposite_ = energy_ < exit_energy_ || distance_ > exit_distance_;
+	}
+	else
+	{
+		opposite_ = energy_ >= enter_energy_ && distance_ > 0 && distance_ <= enter_distance_;
+	}
+	if(opposite_ == false)
+	{
+		pending_ = false;
+		return false;
+	}
+	if(pending_ == false)
+	{
+		pending_ = true;
+		pending_since_ = now;
+	}
+	if(now - pending_since_ < (present_ ? exit_dwell_ : enter_dwell_))
+	{
+		return false;
+	}
+	present_ = !present_;
+	pending_ = false;
+	changes_++;
+	if(callback_ != nullptr)
+	{
+		callback_(present_, reading, callback_context_);
+	}
+	return true;
+}
+
+bool ld2410Presence::present()
+{
+	return present_;
+}
+
+uint8_t ld2410Presence::energy()
+{
+	return (energy_ + 0x80) >> 8;
+}
+
+uint16_t ld2410Presence::distance()
+{
+	return distance_;
+}
+
+uint32_t ld2410Presence::changes()
+{
+	return changes_;
+}
+#endif
@@ -0,0 +1,55 @@
+/*
+ *	Debounced presence detection with hysteresis.
+ *
+ *	presenceDetected() follows the target type of the latest frame, so a marginal target flickers in and out. ld2410Presence only
+ *	reports presence once the smoothed energy and distance have crossed the enter thresholds for the enter dwell time, and only
+ *	reports it has gone once they have crossed the separate exit thresholds for the exit dwell time. Everything per frame is done
+ *	in fixed point. Feed it from a data callback.
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#ifndef ld2410Presence_h
+#define ld2410Presence_h
+#include "ld2410.h"
+
+typedef void (*ld2410PresenceCallback)(bool present, const ld2410Reading &reading, void *context);	//Called on every enter/leave
+
+class ld2410Presence	{
+
+	public:
+		ld2410Presence();													//Constructor function
+		~ld2410Presence();													//Destructor function
+		void setEnergyThresholds(uint8_t enter, uint8_t exit);				//Energy 0-100 needed to enter and to stay, exit is normally lower
+		void setDistanceThresholds(uint16_t enter, uint16_t exit);			//Furthest distance in cm to enter and to stay, exit is normally further
+		void setDwellTimes(uint32_t enter, uint32_t exit);					//How long in ms the change must hold before it is reported
+		void setSmoothing(uint8_t shift);									//Energy EWMA weight of 1/2^shift per frame, 0 turns it off
+		void setCallback(ld2410PresenceCallback callback, void *context = nullptr);	//Called on every enter/leave
+		void reset();														//Back to not present
+		bool update(const ld2410Reading &reading);							//Add a frame, true if presence changed
+		bool update(const ld2410Reading &reading, uint32_t now);			//As above with the time in ms supplied
+		bool present();														//Debounced presence
+		uint8_t energy();													//Smoothed energy of the strongest target
+		uint16_t distance();												//Distance of the strongest target most recently seen
+		uint32_t changes();													//Enters and leaves reported since the last reset
+	protected:
+	private:
+		uint16_t enter_energy_ = 40 << 8;									//Energies are kept as 8.8 fixed point
+		uint16_t exit_energy_ = 20 << 8;
+		uint16_t enter_distance_ = 600;
+		uint16_t exit_distance_ = 700;
+		uint32_t enter_dwell_ = 500;
+		uint32_t exit_dwell_ = 5000;
+		uint8_t smoothing_ = 3;
+		uint16_t energy_ = 0;												//Smoothed, 8.8 fixed point
+		uint16_t distance_ = 0;
+		bool present_ = false;
+		bool pending_ = false;												//The opposite state has been seen and is being timed
+		uint32_t pending_since_ = 0;
+		uint32_t changes_ = 0;
+		ld2410PresenceCallback callback_ = nullptr;
+		void *callback_context_ = nullptr;
+};
+#endif
@@ -0,0 +1,140 @@
+/*
+ *	Streaming quantile estimate in constant memory using the P-squared algorithm (Jain & Chlamtac, 1985).
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#ifndef ld2410Quantile_cpp
+#define ld2410Quantile_cpp
+#include "ld2410Quantile.h"
+
+ld2410Quantile::ld2410Quantile(float quantile) :	//Constructor function
+	quantile_(quantile)
+{
+}
+
+ld2410Quantile::~ld2410Quantile()	//Destructor function
+{
+}
+
+void ld2410Quantile::reset(float quantile)
+{
+	quantile_ = quantile;
+	samples_ = 0;
+}
+
+void ld2410Quantile::reset()
+{
+	samples_ = 0;
+}
+
+uint16_t ld2410Quantile::samples()
+{
+	return samples_;
+}
+
+float ld2410Quantile::position_(uint8_t marker)
+{
+	if(marker == 0)
+	{
+		return 1;
+	}
+	if(marker == 4)
+	{
+		return samples_;
+	}
+	return positions_[marker - 1];
+}
+
+float ld2410Quantile::parabolic_(uint8_t marker, int8_t direction)
+{
+	float below_ = position_(marker - 1);
+	float here_ = position_(marker);
+	float above_ = position_(marker + 1);
+	return heights_[marker] + direction / (above_ - below_) *
+		((here_ - below_ + direction) * (heights_[marker + 1] - heights_[marker]) / (above_ - here_) +
+		(above_ - here_ - direction) * (heights_[marker] - heights_[marker - 1]) / (here_ - below_));
+}
+
+void ld2410Quantile::add(float sample)
+{
+	if(samples_ == 0xFFFF)
+	{
+		return;
+	}
+	if(samples_ < 5)	//Collect the first five, sorted, as the initial markers
+	{
+		uint8_t i = samples_++;
+		while(i > 0 && heights_[i - 1] > sample)
+		{
+			heights_[i] = heights_[i - 1];
+			i--;
+		}
+		heights_[i] = sample;
+		positions_[0] = 2;
+		positions_[1] = 3;
+		positions_[2] = 4;
+		return;
+	}
+	uint8_t cell_;	//Which pair of markers the sample falls between, moving the extremes if needed
+	if(sample < heights_[0])
+	{
+		heights_[0] = sample;
+		cell_ = 0;
+	}
+	else if(sample >= heights_[4])
+	{
+		heights_[4] = sample;
+		cell_ = 3;
+	}
+	else
+	{
+		cell_ = 0;
+		while(sample >= heights_[cell_ + 1])
+		{
+			cell_++;
+		}
+	}
+	samples_++;	//Moves the last marker
+	for(uint8_t i = cell_; i < 3; i++)
+	{
+		positions_[i]++;
+	}
+	const float increments_[3] = {quantile_ / 2, quantile_, (1 + quantile_) / 2};
+	for(uint8_t marker = 1; marker < 4; marker++)	//Nudge the middle markers towards their desired positions
+	{
+		float desired_ = 1 + (samples_ - 1) * increments_[marker - 1];
+		float here_ = position_(marker);
+		float difference_ = desired_ - here_;
+		if((difference_ >= 1 && position_(marker + 1) - here_ > 1) || (difference_ <= -1 && position_(marker - 1) - here_ < -1))
+		{
+			int8_t direction_ = difference_ > 0 ? 1 : -1;
+			float height_ = parabolic_(marker, direction_);
+			if(heights_[marker - 1] < height_ && height_ < heights_[marker + 1])
+			{
+				heights_[marker] = height_;
+			}
+			else	//Fall back to linear
+			{
+				heights_[marker] += direction_ * (heights_[marker + direction_] - heights_[marker]) / (position_(marker + direction_) - here_);
+			}
+			positions_[marker - 1] += direction_;
+		}
+	}
+}
+
+float ld2410Quantile::estimate()
+{
+	if(samples_ == 0)
+	{
+		return 0;
+	}
+	if(samples_ < 5)	//Nearest rank of what there is
+	{
+		return heights_[(uint8_t)(quantile_ * (samples_ - 1) + 0.5f)];
+	}
+	return heights_[2];
+}
+#endif
@@ -0,0 +1,34 @@
+/*
+ *	Streaming quantile estimate in constant memory using the P-squared algorithm (Jain & Chlamtac, 1985).
+ *
+ *	Five markers are adjusted as each sample arrives, so no samples are stored. Up to 65535 samples are used, any more are ignored.
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#ifndef ld2410Quantile_h
+#define ld2410Quantile_h
+#include <stdint.h>
+
+class ld2410Quantile	{
+
+	public:
+		ld2410Quantile(float quantile = 0.95);								//Constructor function, eg. 0.95 for the 95th percentile
+		~ld2410Quantile();													//Destructor function
+		void reset(float quantile);											//Start again, estimating a different quantile
+		void reset();														//Start again
+		void add(float sample);
+		float estimate();													//Current estimate, 0 if there are no samples
+		uint16_t samples();
+	protected:
+	private:
+		float quantile_;
+		float heights_[5];													//Marker heights, the first five samples until there are five
+		uint16_t positions_[3];												//Positions of the middle three markers, the outer two are always 1 and samples_
+		uint16_t samples_ = 0;
+		float position_(uint8_t marker);									//Actual position of any marker
+		float parabolic_(uint8_t marker, int8_t direction);					//P-squared piecewise parabolic prediction
+};
+#endif
@@ -0,0 +1,64 @@
+/*
+ *	Bounded single-producer/single-consumer queue for passing decoded frames between tasks.
+ *
+ *	One task may call push() and one other task may call pop(), without locks. Needs <atomic>, so it is not available on AVR.
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#ifndef ld2410Queue_h
+#define ld2410Queue_h
+#if defined(__has_include)
+	#if __has_include(<atomic>)
+		#define LD2410_HAS_ATOMIC
+	#endif
+#endif
+#ifdef LD2410_HAS_ATOMIC
+#include <atomic>
+#include <stdint.h>
+
+template<typename T, uint16_t N> class ld2410Queue	{
+	static_assert(N > 0 && (N & (N - 1)) == 0, "ld2410Queue length must be a power of two");
+
+	public:
+		bool push(const T &item)										//Producer only, false and counted as an overflow if full
+		{
+			uint32_t head = head_.load(std::memory_order_relaxed);
+			if(head - tail_.load(std::memory_order_acquire) == N)
+			{
+				overflows_.store(overflows_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+				return false;
+			}
+			items_[head & (N - 1)] = item;
+			head_.store(head + 1, std::memory_order_release);
+			return true;
+		}
+		bool pop(T &item)												//Consumer only, false if empty
+		{
+			uint32_t tail = tail_.load(std::memory_order_relaxed);
+			if(tail == head_.load(std::memory_order_acquire))
+			{
+				return false;
+			}
+			item = items_[tail & (N - 1)];
+			tail_.store(tail + 1, std::memory_order_release);
+			return true;
+		}
+		uint16_t size()													//Items waiting, a snapshot from either side
+		{
+			return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+		}
+		uint32_t overflows()											//Items dropped because the consumer fell behind
+		{
+			return overflows_.load(std::memory_order_relaxed);
+		}
+	private:
+		T items_[N];
+		std::atomic<uint32_t> head_{0};									//Free running, written by the producer
+		std::atomic<uint32_t> tail_{0};									//Free running, written by the consumer
+		std::atomic<uint32_t> overflows_{0};							//Written by the producer
+};
+#endif
+#endif
@@ -0,0 +1,192 @@
+/*
+ *	A Stream over a Linux serial device, for using the library natively on Linux.
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#ifndef ld2410Serial_cpp
+#define ld2410Serial_cpp
+#include "ld2410Serial.h"
+#ifdef LD2410_LINUX_PORT
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <asm/termbits.h>												//termios2, so any baud rate can be set, eg. 256000
+
+ld2410Serial::ld2410Serial()	//Constructor function
+{
+}
+
+ld2410Serial::~ld2410Serial()	//Destructor function
+{
+	end();
+}
+
+bool ld2410Serial::begin(const char *device, uint32_t baudRate)
+{
+	end();
+	fd_ = open(device, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+	if(fd_ < 0)
+	{
+		return false;
+	}
+	if(setBaudRate(baudRate) == false)
+	{
+		end();
+		return false;
+	}
+	ioctl(fd_, TCFLSH, TCIOFLUSH);	//Discard anything left from before
+	return true;
+}
+
+void ld2410Serial::end()
+{
+	if(fd_ >= 0)
+	{
+		close(fd_);
+		fd_ = -1;
+	}
+	buffer_position_ = 0;
+	buffer_length_ = 0;
+}
+
+bool ld2410Serial::setBaudRate(uint32_t baudRate)
+{
+	struct termios2 settings_;
+	if(fd_ < 0 || ioctl(fd_, TCGETS2, &settings_) != 0)
+	{
+		return false;
+	}
+	settings_.c_iflag = 0;	//Raw 8N1, no flow control
+	settings_.c_oflag = 0;
+	settings_.c_lflag = 0;
+	settings_.c_cflag = CS8 | CREAD | CLOCAL | BOTHER;
+	settings_.c_ispeed = baudRate;
+	settings_.c_ospeed = baudRate;
+	settings_.c_cc[VMIN] = 0;
+	settings_.c_cc[VTIME] = 0;
+	return ioctl(fd_, TCSETS2, &settings_) == 0;
+}
+
+void ld2410Serial::baudCallback(uint32_t baudRate, void *serial)
+{
+	static_cast<ld2410Serial *>(serial)->setBaudRate(baudRate);
+}
+
+int ld2410Serial::fd()
+{
+	return fd_;
+}
+
+bool ld2410Serial::wait(int timeout)
+{
+	if(buffer_position_ < buffer_length_)
+	{
+		return true;
+	}
+	if(fd_ < 0)
+	{
+		return false;
+	}
+	struct pollfd poll_fd_ = {fd_, POLLIN, 0};
+	int result_;
+	do
+	{
+		result_ = poll(&poll_fd_, 1, timeout);
+	}
+	while(result_ < 0 && errno == EINTR);
+	return result_ > 0 && (poll_fd_.revents & POLLIN);
+}
+
+bool ld2410Serial::fill_()
+{
+	if(buffer_position_ < buffer_length_)
+	{
+		return true;
+	}
+	if(fd_ < 0)
+	{
+		return false;
+	}
+	ssize_t length_ = ::read(fd_, buffer_, LD2410_SERIAL_BUFFER_LENGTH);	//Never waits, the device is non-blocking
+	if(length_ <= 0)
+	{
+		return false;
+	}
+	buffer_position_ = 0;
+	buffer_length_ = length_;
+	return true;
+}
+
+int ld2410Serial::available()
+{
+	int waiting_ = 0;
+	if(fd_ >= 0)
+	{
+		ioctl(fd_, FIONREAD, &waiting_);	//Still in the kernel
+	}
+	return buffer_length_ - buffer_position_ + waiting_;
+}
+
+int ld2410Serial::read()
+{
+	if(fill_() == false)
+	{
+		return -1;
+	}
+	return buffer_[buffer_position_++];
+}
+
+int ld2410Serial::peek()
+{
+	if(fill_() == false)
+	{
+		return -1;
+	}
+	return buffer_[buffer_position_];
+}
+
+size_t ld2410Serial::write(uint8_t byte)
+{
+	return write(&byte, 1);
+}
+
+size_t ld2410Serial::write(const uint8_t *buffer, size_t size)
+{
+	size_t written_ = 0;
+	while(fd_ >= 0 && written_ < size)
+	{
+		ssize_t length_ = ::write(fd_, &buffer[written_], size - written_);
+		if(length_ > 0)
+		{
+			written_ += length_;
+		}
+		else if(length_ < 0 && (errno == EAGAIN || errno == EINTR))	//Full, wait for room rather than dropping part of a command
+		{
+			struct pollfd poll_fd_ = {fd_, POLLOUT, 0};
+			if(poll(&poll_fd_, 1, LD2410_SERIAL_WRITE_TIMEOUT) == 0)
+			{
+				break;
+			}
+		}
+		else
+		{
+			break;
+		}
+	}
+	return written_;
+}
+
+void ld2410Serial::flush()
+{
+	if(fd_ >= 0)
+	{
+		ioctl(fd_, TCSBRK, 1);	//tcdrain()
+	}
+}
+#endif
+#endif
@@ -0,0 +1,51 @@
+/*
+ *	A Stream over a Linux serial device, eg. a USB-UART adapter at /dev/ttyUSB0, for using the library natively on Linux.
+ *
+ *	The device is opened non-blocking and in raw mode, at any baud rate the adapter supports including 256000. Reads never wait,
+ *	use wait() or put fd() in your own poll/epoll loop to sleep until data arrives.
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#ifndef ld2410Serial_h
+#define ld2410Serial_h
+#include "ld2410.h"
+#ifdef LD2410_LINUX_PORT
+
+#ifndef LD2410_SERIAL_BUFFER_LENGTH
+	#define LD2410_SERIAL_BUFFER_LENGTH 256									//Bytes read from the device at a time
+#endif
+#ifndef LD2410_SERIAL_WRITE_TIMEOUT
+	#define LD2410_SERIAL_WRITE_TIMEOUT 100									//How long write() waits for room in the device (ms)
+#endif
+
+class ld2410Serial : public Stream	{
+
+	public:
+		ld2410Serial();													//Constructor function
+		~ld2410Serial();												//Destructor function, closes the device
+		bool begin(const char *device, uint32_t baudRate = LD2410_DEFAULT_BAUD_RATE);	//Open the device, false if it can't be opened or configured
+		void end();
+		bool setBaudRate(uint32_t baudRate);							//Change the baud rate of the open device
+		static void baudCallback(uint32_t baudRate, void *serial);		//For ld2410::begin() and detectBaudRate(), with the ld2410Serial as context
+		int fd();														//File descriptor for poll/epoll, -1 if not open
+		bool wait(int timeout);											//Sleep until data arrives or the timeout (ms, -1 forever) expires
+		int available() override;
+		int read() override;
+		int peek() override;
+		size_t write(uint8_t byte) override;
+		size_t write(const uint8_t *buffer, size_t size) override;
+		void flush() override;											//Wait until everything written has been sent
+		using Print::write;
+	protected:
+	private:
+		int fd_ = -1;
+		uint8_t buffer_[LD2410_SERIAL_BUFFER_LENGTH];					//Read from the device, not yet consumed
+		uint16_t buffer_position_ = 0;
+		uint16_t buffer_length_ = 0;
+		bool fill_();													//Read whatever the device has if the buffer is empty
+};
+#endif
+#endif
@@ -0,0 +1,23 @@
+/*
+ *	Somewhere to keep small values across restarts, used to remember the sensor configuration.
+ *
+ *	Implement load() and save() over whatever the board has, eg. Preferences on ESP32 or EEPROM on AVR. ld2410FileStorage is an
+ *	implementation using files on Linux.
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#ifndef ld2410Storage_h
+#define ld2410Storage_h
+#include <stdint.h>
+
+class ld2410Storage	{
+
+	public:
+		virtual ~ld2410Storage() {}											//Destructor function
+		virtual bool load(const char *key, uint8_t *data, uint16_t length) = 0;	//Fill data with the length bytes saved under key, false if there aren't any
+		virtual bool save(const char *key, const uint8_t *data, uint16_t length) = 0;	//Replace anything saved under key, false if it couldn't be written
+};
+#endif
@@ -0,0 +1,149 @@
+/*
+ *	Runs an ld2410 in its own task, publishing every decoded data frame into a lock-free queue for another task to consume.
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#ifndef ld2410Task_cpp
+#define ld2410Task_cpp
+#include "ld2410Task.h"
+#ifdef LD2410_HAS_TASK
+#if !defined(ESP32)
+#include <chrono>
+#endif
+
+ld2410Task::ld2410Task(ld2410 &radar) :	//Constructor function
+	radar_(radar)
+{
+}
+
+ld2410Task::~ld2410Task()	//Destructor function
+{
+	stop();
+}
+
+#if defined(ESP32)
+bool ld2410Task::start(uint32_t stackSize, UBaseType_t priority, BaseType_t core)
+{
+	if(running_ || finished_ == false)
+	{
+		return false;
+	}
+	running_ = true;
+	finished_ = false;
+	radar_.setDataCallback(frame_decoded_, this);
+	if(xTaskCreatePinnedToCore(task_function_, "ld2410", stackSize, this, priority, &task_handle_, core) != pdPASS)
+	{
+		radar_.setDataCallback(nullptr);
+		running_ = false;
+		finished_ = true;
+		return false;
+	}
+	callback_registered_ = true;
+	return true;
+}
+
+void ld2410Task::task_function_(void *task)
+{
+	ld2410Task *self_ = static_cast<ld2410Task *>(task);
+	self_->run_();
+	self_->task_handle_ = nullptr;
+	self_->finished_ = true;
+	vTaskDelete(nullptr);
+}
+
+void ld2410Task::stop()
+{
+	running_ = false;
+	while(finished_ == false)
+	{
+		vTaskDelay(1);
+	}
+	release_callback_();
+}
+#else
+bool ld2410Task::start()
+{
+	if(running_ || thread_.joinable())
+	{
+		return false;
+	}
+	running_ = true;
+	radar_.setDataCallback(frame_decoded_, this);
+	callback_registered_ = true;
+	thread_ = std::thread(&ld2410Task::run_, this);
+	return true;
+}
+
+void ld2410Task::stop()
+{
+	running_ = false;
+	if(thread_.joinable())
+	{
+		thread_.join();
+	}
+	release_callback_();
+}
+#endif
+
+void ld2410Task::release_callback_()
+{
+	if(callback_registered_)	//Leave a callback the application set alone if this task never started
+	{
+		radar_.setDataCallback(nullptr);
+		callback_registered_ = false;
+	}
+}
+
+bool ld2410Task::running()
+{
+	return running_;
+}
+
+void ld2410Task::run_()
+{
+	while(running_)
+	{
+		if(radar_.readAvailable() == 0)	//Nothing complete yet, let other tasks run while more arrives
+		{
+			#if defined(ESP32)
+			vTaskDelay(1);
+			#else
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			#endif
+		}
+	}
+}
+
+void ld2410Task::frame_decoded_(const ld2410Reading &reading, void *context)
+{
+	ld2410Task *self_ = static_cast<ld2410Task *>(context);
+	if(self_->queue_.push(reading))
+	{
+		self_->published_.store(self_->published_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	}
+}
+
+bool ld2410Task::read(ld2410Reading &reading)
+{
+	return queue_.pop(reading);
+}
+
+uint16_t ld2410Task::queued()
+{
+	return queue_.size();
+}
+
+uint32_t ld2410Task::published()
+{
+	return published_.load(std::memory_order_relaxed);
+}
+
+uint32_t ld2410Task::overflows()
+{
+	return queue_.overflows();
+}
+#endif
+#endif
@@ -0,0 +1,59 @@
+/*
+ *	Runs an ld2410 in its own task, publishing every decoded data frame into a lock-free queue for another task to consume.
+ *
+ *	On ESP32 this is a FreeRTOS task, on Linux a std::thread. While the task is running it owns the ld2410 and its UART, don't call
+ *	the ld2410 from other tasks until stop() has returned.
+ *
+ *	https://github.com/ncmreynolds/ld2410
+ *
+ *	Released under LGPL-2.1 see https://github.com/ncmreynolds/ld2410/LICENSE for full license
+ *
+ */
+#ifndef ld2410Task_h
+#define ld2410Task_h
+#include "ld2410.h"
+#include "ld2410Queue.h"
+#if defined(LD2410_HAS_ATOMIC) && (defined(ESP32) || defined(__linux__))
+#define LD2410_HAS_TASK
+#if !defined(ESP32)
+#include <thread>
+#endif
+
+#define LD2410_TASK_QUEUE_LENGTH 16										//Frames buffered between the tasks, must be a power of two
+
+class ld2410Task	{
+
+	public:
+		ld2410Task(ld2410 &radar);										//Constructor function
+		~ld2410Task();													//Destructor function, stops the task
+		#if defined(ESP32)
+		bool start(uint32_t stackSize = 4096, UBaseType_t priority = 1, BaseType_t core = tskNO_AFFINITY);	//Start reading in a FreeRTOS task
+		#else
+		bool start();													//Start reading in a thread
+		#endif
+		void stop();													//Stop the task and wait for it to finish
+		bool running();
+		bool read(ld2410Reading &reading);								//Take the oldest decoded frame, false if there are none
+		uint16_t queued();												//Frames waiting to be read
+		uint32_t published();											//Frames put in the queue since starting
+		uint32_t overflows();											//Frames dropped because the queue was full
+	protected:
+	private:
+		ld2410 &radar_;
+		ld2410Queue<ld2410Reading, LD2410_TASK_QUEUE_LENGTH> queue_;
+		std::atomic<bool> running_{false};								//Cleared to ask the task to stop
+		std::atomic<uint32_t> published_{0};
+		bool callback_registered_ = false;								//Set by start(), so stop() only removes its own data callback
+		#if defined(ESP32)
+		std::atomic<bool> finished_{true};								//Set by the task as it exits
+		TaskHandle_t task_handle_ = nullptr;
+		static void task_function_(void *task);
+		#else
+		std::thread thread_;
+		#endif
+		void run_();													//The task body
+		void release_callback_();										//Remove the data callback if start() set it
+		static void frame_decoded_(const ld2410Reading &reading, void *context);	//Data callback from the ld2410
+};
+#endif
+#endif